@@ -0,0 +1,483 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Config.hpp"
+
+const uint32_t CHECKPOINT_VERSION = 3; // версия формата снимка
+
+// заголовок снимка: за ним следуют конфигурация, гены, оценки, флаги изменения и дополнительное состояние популяции,
+// каждый блок выровнен на 64 байта
+struct CheckpointHeader {
+	char magic[8]; // сигнатура "GACHECK"
+	uint32_t version; // версия формата
+	uint32_t bits; // число бит гена
+	uint64_t dimensions; // число генов особи
+	uint64_t populationSize; // размер популяции
+	uint64_t epoch; // номер следующей эпохи
+	uint64_t nochangingIterations; // число эпох без улучшения
+	double prevBest; // лучшее значение предыдущей эпохи
+	uint64_t random[4]; // состояние генератора случайных чисел популяции
+	uint64_t configOffset; // смещение конфигурации
+	uint64_t configSize; // размер конфигурации
+	uint64_t genesOffset; // смещение генов
+	uint64_t scoresOffset; // смещение оценок
+	uint64_t dirtyOffset; // смещение флагов изменения
+	uint64_t extraOffset; // смещение дополнительного состояния популяции (кэш оценок, списки локального поиска)
+	uint64_t extraSize; // размер дополнительного состояния популяции
+	uint64_t fileSize; // полный размер файла
+};
+
+// состояние цикла эпох, сохраняемое вместе с популяцией
+struct CheckpointState {
+	size_t epoch; // номер следующей эпохи
+	size_t nochangingIterations; // число эпох без улучшения
+	double prevBest; // лучшее значение предыдущей эпохи
+};
+
+// последовательная запись значений в двоичный блок
+class BinaryWriter {
+	std::vector<char> &data; // заполняемый блок
+public:
+	BinaryWriter(std::vector<char> &data);
+
+	template <typename T>
+	void Write(const T &value); // запись значения простого типа
+	void Write(const std::string &value); // запись строки с длиной
+	void Write(const std::vector<double> &values); // запись массива с длиной
+	void WriteBytes(const void *bytes, size_t count); // запись count байт без длины
+};
+
+// последовательное чтение значений из двоичного блока
+class BinaryReader {
+	const char *data; // читаемый блок
+	size_t size; // размер блока
+	size_t position; // текущая позиция
+
+	const char* Take(size_t count); // получение очередных count байт
+public:
+	BinaryReader(const char *data, size_t size);
+
+	template <typename T>
+	void Read(T &value); // чтение значения простого типа
+	void Read(std::string &value); // чтение строки с длиной
+	void Read(std::vector<double> &values); // чтение массива с длиной
+	void ReadBytes(void *bytes, size_t count); // чтение count байт без длины
+	size_t GetRemaining() const; // получение числа непрочитанных байт
+};
+
+// снимок популяции, отображённый в память только для чтения
+class Checkpoint {
+	const char *data; // содержимое файла
+	size_t size; // размер файла
+	std::vector<char> content; // содержимое файла без поддержки отображения в память
+
+	const CheckpointHeader& GetHeader() const; // получение заголовка
+	void Release(); // освобождение отображения
+public:
+	Checkpoint(const std::string &path); // отображение файла в память и проверка заголовка
+	~Checkpoint();
+
+	Checkpoint(const Checkpoint&) = delete;
+	Checkpoint& operator=(const Checkpoint&) = delete;
+
+	Config GetConfig(const Config &config) const; // получение сохранённой конфигурации поверх заданной
+	CheckpointState GetState() const; // получение состояния цикла эпох
+	unsigned GetBits() const; // получение числа бит гена
+	size_t GetEntities() const; // получение размера популяции
+	size_t GetDimensions() const; // получение числа генов особи
+
+	void GetRandom(uint64_t state[4]) const; // получение состояния генератора
+	const void* GetGenes() const; // получение генов всех особей подряд
+	size_t GetGenesSize() const; // получение размера блока генов в байтах
+	const double* GetScores() const; // получение оценок особей
+	const uint8_t* GetDirty() const; // получение флагов изменения особей
+	BinaryReader GetExtra() const; // получение чтения дополнительного состояния популяции
+};
+
+BinaryWriter::BinaryWriter(std::vector<char> &data) : data(data) {
+}
+
+// запись значения простого типа
+template <typename T>
+void BinaryWriter::Write(const T &value) {
+	const char *bytes = (const char *) &value;
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+// запись строки с длиной
+void BinaryWriter::Write(const std::string &value) {
+	Write((uint64_t) value.size());
+	data.insert(data.end(), value.begin(), value.end());
+}
+
+// запись массива с длиной
+void BinaryWriter::Write(const std::vector<double> &values) {
+	Write((uint64_t) values.size());
+
+	for (size_t i = 0; i < values.size(); i++)
+		Write(values[i]);
+}
+
+// запись count байт без длины
+void BinaryWriter::WriteBytes(const void *bytes, size_t count) {
+	data.insert(data.end(), (const char *) bytes, (const char *) bytes + count);
+}
+
+BinaryReader::BinaryReader(const char *data, size_t size) : data(data), size(size), position(0) {
+}
+
+// получение очередных count байт
+const char* BinaryReader::Take(size_t count) {
+	if (count > size - position)
+		throw std::runtime_error("checkpoint is truncated");
+
+	const char *bytes = data + position;
+	position += count;
+	return bytes;
+}
+
+// чтение значения простого типа
+template <typename T>
+void BinaryReader::Read(T &value) {
+	memcpy(&value, Take(sizeof(T)), sizeof(T));
+}
+
+// чтение строки с длиной
+void BinaryReader::Read(std::string &value) {
+	uint64_t length;
+	Read(length);
+	const char *bytes = Take(length);
+	value.assign(bytes, bytes + length);
+}
+
+// чтение массива с длиной
+void BinaryReader::Read(std::vector<double> &values) {
+	uint64_t length;
+	Read(length);
+
+	if (length > size / sizeof(double))
+		throw std::runtime_error("checkpoint is truncated");
+
+	values.resize(length);
+
+	for (size_t i = 0; i < length; i++)
+		Read(values[i]);
+}
+
+// чтение count байт без длины
+void BinaryReader::ReadBytes(void *bytes, size_t count) {
+	memcpy(bytes, Take(count), count);
+}
+
+// получение числа непрочитанных байт
+size_t BinaryReader::GetRemaining() const {
+	return size - position;
+}
+
+// запись параметров конфигурации (производные значения пересчитываются при чтении)
+void WriteConfig(BinaryWriter &writer, const Config &config) {
+	writer.Write(config.mode);
+	writer.Write((uint64_t) config.dimensions);
+	writer.Write(config.leftBorders);
+	writer.Write(config.rightBorders);
+	writer.Write((uint32_t) config.genomeBits);
+	writer.Write((uint64_t) config.populationSize);
+	writer.Write((uint64_t) config.maxEpochs);
+	writer.Write((uint64_t) config.maxValuelessEpochs);
+	writer.Write(config.qualityEpsilon);
+	writer.Write(config.preservedPart);
+	writer.Write((int32_t) config.selectionType);
+	writer.Write((uint64_t) config.tournamentSize);
+	writer.Write(config.selectionPart);
+	writer.Write((int32_t) config.crossbreedingType);
+	writer.Write((int32_t) config.mutationType);
+	writer.Write(config.mutationProbability);
+	writer.Write((int32_t) config.diversityPolicy);
+	writer.Write(config.diversityThreshold);
+	writer.Write(config.diversityBoost);
+	writer.Write((uint64_t) config.memeticElites);
+	writer.Write((uint64_t) config.memeticBudget);
+	writer.Write((int32_t) config.algorithmType);
+	writer.Write((int32_t) config.replacementType);
+	writer.Write(config.seed);
+	writer.Write((uint64_t) config.threads);
+	writer.Write((uint64_t) config.parallelThreshold);
+	writer.Write((uint64_t) config.cacheSize);
+	writer.Write((int32_t) config.telemetryFormat);
+	writer.Write(config.telemetryPath);
+	writer.Write((uint8_t) config.telemetryPopulation);
+	writer.Write((uint64_t) config.telemetryBuffer);
+	writer.Write(config.function);
+	writer.Write((uint64_t) config.objectives);
+	writer.Write(config.pluginPath);
+	writer.Write(config.pluginArgs);
+	writer.Write((uint8_t) config.debug);
+}
+
+// чтение параметров конфигурации поверх заданной (параметры снимков и островов остаются текущими)
+void ReadConfig(BinaryReader &reader, Config &config) {
+	uint64_t u64;
+	uint32_t u32;
+	int32_t i32;
+	uint8_t u8;
+
+	reader.Read(config.mode);
+	reader.Read(u64); config.dimensions = u64;
+	reader.Read(config.leftBorders);
+	reader.Read(config.rightBorders);
+	reader.Read(u32); config.genomeBits = u32;
+	reader.Read(u64); config.populationSize = u64;
+	reader.Read(u64); config.maxEpochs = u64;
+	reader.Read(u64); config.maxValuelessEpochs = u64;
+	reader.Read(config.qualityEpsilon);
+	reader.Read(config.preservedPart);
+	reader.Read(i32); config.selectionType = (SelectionType) i32;
+	reader.Read(u64); config.tournamentSize = u64;
+	reader.Read(config.selectionPart);
+	reader.Read(i32); config.crossbreedingType = (CrossbreedingType) i32;
+	reader.Read(i32); config.mutationType = (MutationType) i32;
+	reader.Read(config.mutationProbability);
+	reader.Read(i32); config.diversityPolicy = (DiversityPolicy) i32;
+	reader.Read(config.diversityThreshold);
+	reader.Read(config.diversityBoost);
+	reader.Read(u64); config.memeticElites = u64;
+	reader.Read(u64); config.memeticBudget = u64;
+	reader.Read(i32); config.algorithmType = (AlgorithmType) i32;
+	reader.Read(i32); config.replacementType = (ReplacementType) i32;
+	reader.Read(config.seed);
+	reader.Read(u64); config.threads = u64;
+	reader.Read(u64); config.parallelThreshold = u64;
+	reader.Read(u64); config.cacheSize = u64;
+	reader.Read(i32); config.telemetryFormat = (TelemetryFormat) i32;
+	reader.Read(config.telemetryPath);
+	reader.Read(u8); config.telemetryPopulation = u8;
+	reader.Read(u64); config.telemetryBuffer = u64;
+	reader.Read(config.function);
+	reader.Read(u64); config.objectives = u64;
+	reader.Read(config.pluginPath);
+	reader.Read(config.pluginArgs);
+	reader.Read(u8); config.debug = u8;
+
+	EvalConfig(config);
+}
+
+// выравнивание смещения на 64 байта
+uint64_t AlignOffset(uint64_t offset) {
+	return (offset + 63) / 64 * 64;
+}
+
+// запись снимка: сначала во временный файл, затем атомарная замена старого снимка
+void WriteCheckpoint(const std::string &path, const Config &config, const CheckpointState &state, unsigned bits, const uint64_t random[4], const void *genes, size_t genesSize, const double *scores, const std::vector<bool> &dirty, const std::vector<char> &extra) {
+	std::vector<char> configData;
+	BinaryWriter writer(configData);
+	WriteConfig(writer, config);
+
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "GACHECK", 8);
+	header.version = CHECKPOINT_VERSION;
+	header.bits = bits;
+	header.dimensions = config.dimensions;
+	header.populationSize = config.populationSize;
+	header.epoch = state.epoch;
+	header.nochangingIterations = state.nochangingIterations;
+	header.prevBest = state.prevBest;
+
+	for (int i = 0; i < 4; i++)
+		header.random[i] = random[i];
+
+	header.configOffset = AlignOffset(sizeof(header));
+	header.configSize = configData.size();
+	header.genesOffset = AlignOffset(header.configOffset + header.configSize);
+	header.scoresOffset = AlignOffset(header.genesOffset + genesSize);
+	header.dirtyOffset = AlignOffset(header.scoresOffset + config.populationSize * sizeof(double));
+	header.extraOffset = AlignOffset(header.dirtyOffset + config.populationSize);
+	header.extraSize = extra.size();
+	header.fileSize = header.extraOffset + header.extraSize;
+
+	std::vector<uint8_t> flags(config.populationSize);
+
+	for (size_t i = 0; i < config.populationSize; i++)
+		flags[i] = dirty[i];
+
+	std::string temporary = path + ".tmp";
+	FILE *f = fopen(temporary.c_str(), "wb");
+
+	if (!f)
+		throw std::runtime_error("unable to write checkpoint '" + temporary + "'");
+
+	// блоки пишутся по своим смещениям, промежутки заполняются нулями
+	const char zeros[64] = { 0 };
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+	ok = ok && fwrite(zeros, 1, header.configOffset - sizeof(header), f) == header.configOffset - sizeof(header);
+	ok = ok && fwrite(configData.data(), 1, configData.size(), f) == configData.size();
+	ok = ok && fwrite(zeros, 1, header.genesOffset - header.configOffset - header.configSize, f) == header.genesOffset - header.configOffset - header.configSize;
+	ok = ok && fwrite(genes, 1, genesSize, f) == genesSize;
+	ok = ok && fwrite(zeros, 1, header.scoresOffset - header.genesOffset - genesSize, f) == header.scoresOffset - header.genesOffset - genesSize;
+	ok = ok && fwrite(scores, sizeof(double), config.populationSize, f) == config.populationSize;
+	ok = ok && fwrite(zeros, 1, header.dirtyOffset - header.scoresOffset - config.populationSize * sizeof(double), f) == header.dirtyOffset - header.scoresOffset - config.populationSize * sizeof(double);
+	ok = ok && fwrite(flags.data(), 1, flags.size(), f) == flags.size();
+	ok = ok && fwrite(zeros, 1, header.extraOffset - header.dirtyOffset - flags.size(), f) == header.extraOffset - header.dirtyOffset - flags.size();
+	ok = ok && fwrite(extra.data(), 1, extra.size(), f) == extra.size();
+	ok = ok && fflush(f) == 0;
+
+#if defined(__unix__)
+	ok = ok && fsync(fileno(f)) == 0; // данные должны оказаться на диске до замены старого снимка
+#endif
+
+	ok = fclose(f) == 0 && ok;
+
+	// старый снимок заменяется только полностью записанным новым, поэтому сбой во время записи его не портит
+	if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+		std::remove(temporary.c_str());
+		throw std::runtime_error("unable to write checkpoint '" + path + "'");
+	}
+}
+
+// существует ли снимок
+bool HasCheckpoint(const std::string &path) {
+	std::ifstream f(path);
+	return path != "" && f.good();
+}
+
+// отображение файла в память и проверка заголовка
+Checkpoint::Checkpoint(const std::string &path) {
+#if defined(__unix__)
+	int fd = open(path.c_str(), O_RDONLY);
+
+	if (fd < 0)
+		throw std::runtime_error("unable to open checkpoint '" + path + "'");
+
+	struct stat info;
+
+	if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(CheckpointHeader)) {
+		close(fd);
+		throw std::runtime_error("invalid checkpoint '" + path + "'");
+	}
+
+	size = info.st_size;
+	void *address = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (address == MAP_FAILED)
+		throw std::runtime_error("unable to map checkpoint '" + path + "'");
+
+	data = (const char *) address;
+#else
+	std::ifstream f(path, std::ios::binary);
+
+	if (!f)
+		throw std::runtime_error("unable to open checkpoint '" + path + "'");
+
+	content.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+	data = content.data();
+	size = content.size();
+#endif
+
+	const CheckpointHeader &header = GetHeader();
+	bool valid = size >= sizeof(CheckpointHeader) && memcmp(header.magic, "GACHECK", 8) == 0 && header.fileSize == size;
+
+	if (!valid || header.version != CHECKPOINT_VERSION) {
+		Release();
+		throw std::runtime_error("invalid or unsupported checkpoint '" + path + "'");
+	}
+}
+
+Checkpoint::~Checkpoint() {
+	Release();
+}
+
+// освобождение отображения
+void Checkpoint::Release() {
+#if defined(__unix__)
+	if (data) {
+		munmap((void *) data, size);
+		data = NULL;
+	}
+#endif
+}
+
+// получение заголовка
+const CheckpointHeader& Checkpoint::GetHeader() const {
+	return *(const CheckpointHeader *) data;
+}
+
+// получение сохранённой конфигурации поверх заданной
+Config Checkpoint::GetConfig(const Config &base) const {
+	const CheckpointHeader &header = GetHeader();
+	Config config = base;
+	BinaryReader reader(data + header.configOffset, header.configSize);
+	ReadConfig(reader, config);
+	return config;
+}
+
+// получение состояния цикла эпох
+CheckpointState Checkpoint::GetState() const {
+	const CheckpointHeader &header = GetHeader();
+	CheckpointState state;
+	state.epoch = header.epoch;
+	state.nochangingIterations = header.nochangingIterations;
+	state.prevBest = header.prevBest;
+	return state;
+}
+
+// получение числа бит гена
+unsigned Checkpoint::GetBits() const {
+	return GetHeader().bits;
+}
+
+// получение размера популяции
+size_t Checkpoint::GetEntities() const {
+	return GetHeader().populationSize;
+}
+
+// получение числа генов особи
+size_t Checkpoint::GetDimensions() const {
+	return GetHeader().dimensions;
+}
+
+// получение состояния генератора
+void Checkpoint::GetRandom(uint64_t state[4]) const {
+	for (int i = 0; i < 4; i++)
+		state[i] = GetHeader().random[i];
+}
+
+// получение генов всех особей подряд
+const void* Checkpoint::GetGenes() const {
+	return data + GetHeader().genesOffset;
+}
+
+// получение размера блока генов в байтах
+size_t Checkpoint::GetGenesSize() const {
+	return GetHeader().scoresOffset - GetHeader().genesOffset;
+}
+
+// получение оценок особей
+const double* Checkpoint::GetScores() const {
+	return (const double *) (data + GetHeader().scoresOffset);
+}
+
+// получение флагов изменения особей
+const uint8_t* Checkpoint::GetDirty() const {
+	return (const uint8_t *) (data + GetHeader().dirtyOffset);
+}
+
+// получение чтения дополнительного состояния популяции
+BinaryReader Checkpoint::GetExtra() const {
+	return BinaryReader(data + GetHeader().extraOffset, GetHeader().extraSize);
+}
@@ -2,6 +2,12 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <ctime>
+#include <cstdint>
 
 enum class SelectionType {
 	Random, // случайная селекция
@@ -23,11 +29,59 @@ enum class MutationType {
 	Reverse // реверс части битов
 };
 
+// топология миграции между островами
+enum class MigrationTopology {
+	Ring, // каждому следующему острову по кольцу
+	Random // случайному острову
+};
+
+// способ запуска островов
+enum class IslandMode {
+	Threads, // потоки одного процесса
+	Processes // отдельные процессы с обменом через разделяемую память
+};
+
+// вид алгоритма
+enum class AlgorithmType {
+	Generational, // поколения с общей оценкой
+	SteadyState, // стационарный: потомки оцениваются и вставляются по одному
+	Nsga2 // многокритериальный NSGA-II
+};
+
+// способ замещения особей в стационарном алгоритме
+enum class ReplacementType {
+	Worst, // замещается худшая особь популяции
+	Tournament // замещается худшая из участников турнира
+};
+
+// действие при потере разнообразия популяции
+enum class DiversityPolicy {
+	None, // разнообразие не отслеживается
+	Mutation, // повышение вероятности мутации
+	Restart // замена незащищённых особей случайными
+};
+
+// способ перебора параметров
+enum class SweepMode {
+	None, // обычный запуск без перебора
+	Grid, // все сочетания значений
+	Random // случайные сочетания значений
+};
+
+// формат телеметрии
+enum class TelemetryFormat {
+	None, // телеметрия отключена
+	Csv, // строки CSV
+	JsonLines // по одному JSON объекту на строку
+};
+
 struct Config {
 	std::string mode; // режим работы (min/max)
 	int scale; // множитель для сравнений
-	double leftBorder; // левая граница пространства поиска
-	double rightBorder; // правая граница пространства поиска
+	size_t dimensions; // число измерений пространства поиска
+	std::vector<double> leftBorders; // левые границы пространства поиска по измерениям
+	std::vector<double> rightBorders; // правые границы пространства поиска по измерениям
+	unsigned genomeBits; // число бит генома
 
 	size_t populationSize; // размер популяции
 
@@ -39,6 +93,7 @@ struct Config {
 	size_t preservedPositions; // число сохраняемых особей
 
 	SelectionType selectionType; // тип отбора
+	size_t tournamentSize; // число участников турнира
 	double selectionPart; // доля отбираемых
 	size_t selectionSize; // количество отбираемых особей
 
@@ -47,21 +102,86 @@ struct Config {
 	MutationType mutationType; // тип мутации
 	double mutationProbability; // вероятность мутации
 
+	DiversityPolicy diversityPolicy; // действие при потере разнообразия
+	double diversityThreshold; // порог разнообразия (среднее расстояние Хэмминга, отнесённое к половине числа бит особи)
+	double diversityBoost; // множитель вероятности мутации при потере разнообразия
+
+	size_t memeticElites; // число защищённых особей, улучшаемых локальным поиском (0 - без локального поиска)
+	size_t memeticBudget; // число вычислений оценочной функции на локальный поиск за эпоху
+
+	AlgorithmType algorithmType; // вид алгоритма
+	ReplacementType replacementType; // способ замещения в стационарном алгоритме
+
+	uint64_t seed; // начальное значение генератора случайных чисел
+
+	size_t threads; // число потоков для оценки приспособленности
+	size_t parallelThreshold; // минимальный размер популяции для параллельной оценки
+
+	size_t cacheSize; // размер кэша значений оценочной функции (0 - без кэша)
+
+	size_t islands; // число островов (1 - одна популяция)
+	size_t migrationInterval; // число эпох между миграциями
+	size_t migrationSize; // число мигрирующих лучших особей
+	MigrationTopology migrationTopology; // топология миграции
+	bool pinThreads; // привязка потоков островов к ядрам
+	IslandMode islandMode; // способ запуска островов
+	std::vector<std::pair<size_t, std::string>> islandSettings; // параметры отдельных островов (номер острова, строка параметра)
+
+	TelemetryFormat telemetryFormat; // формат телеметрии
+	std::string telemetryPath; // файл телеметрии
+	bool telemetryPopulation; // записывать ли снимки всей популяции
+	size_t telemetryBuffer; // число записей в буфере телеметрии
+
+	std::string checkpointPath; // файл снимка популяции (пустая строка - без снимков)
+	size_t checkpointInterval; // число эпох между снимками
+	bool resume; // продолжать ли работу из снимка
+
+	SweepMode sweepMode; // способ перебора параметров
+	size_t sweepSamples; // число случайных сочетаний
+	size_t sweepSeeds; // число запусков с разными seed на каждое сочетание
+	size_t sweepThreads; // число потоков перебора
+	std::vector<std::pair<std::string, std::string>> sweepSettings; // перебираемые параметры (имя параметра, значения через запятую)
+
+	std::string function; // выражение оценочной функции (пустая строка - функция из main.cpp)
+	size_t objectives; // число целей (выражений функции через ';')
+	std::string paretoPath; // файл фронта Парето многокритериального алгоритма (пустая строка - только вывод)
+	std::string pluginPath; // разделяемая библиотека с оценочной функцией (пустая строка - функция из main.cpp)
+	std::string pluginArgs; // строка параметров, передаваемая библиотеке при инициализации
+
 	bool debug; // отладочный режим для популяции
 };
 
+// приведение списка границ к числу измерений
+void EvalBorders(std::vector<double> &borders, size_t dimensions) {
+	// одна граница задаёт одинаковые значения для всех измерений
+	if (borders.size() == 1)
+		borders.assign(dimensions, borders[0]);
+
+	if (borders.size() != dimensions)
+		throw std::runtime_error("number of borders does not match dimensions");
+}
+
 void EvalConfig(Config &config) {
+	EvalBorders(config.leftBorders, config.dimensions);
+	EvalBorders(config.rightBorders, config.dimensions);
+
 	config.scale = config.mode == "max" ? 1 : -1;
 	config.preservedPositions = (config.preservedPart >= 1 ? config.preservedPart : config.preservedPart * config.populationSize);
 	config.selectionSize = (config.selectionPart >= 1 ? config.selectionPart : config.selectionPart * config.populationSize);
+
+	// защищённые особи входят в число отобранных, а отобранные - в популяцию, поэтому буферы родителей не переполняются
+	config.preservedPositions = std::min(config.preservedPositions, config.populationSize);
+	config.selectionSize = std::min(std::max(config.selectionSize, config.preservedPositions), config.populationSize);
 }
 
 Config GetDefaultConfig() {
 	Config config;
 
 	config.mode = "max";
-	config.leftBorder = 0;
-	config.rightBorder = 10;
+	config.dimensions = 1; // функция одной переменной
+	config.leftBorders = { 0 };
+	config.rightBorders = { 10 };
+	config.genomeBits = 30; // 30 бит на геном
 
 	config.populationSize = 40;
 
@@ -72,6 +192,7 @@ Config GetDefaultConfig() {
 	config.preservedPart = 2; // сохраняем две лучших особи
 
 	config.selectionType = SelectionType::Roullete; // отбираем рулеткой
+	config.tournamentSize = 2; // турнир из двух особей
 	config.selectionPart = 0.4; // 40% дают потомство
 
 	config.crossbreedingType = CrossbreedingType::TwoPoint; // двухточечное скрещивание
@@ -79,6 +200,50 @@ Config GetDefaultConfig() {
 	config.mutationType = MutationType::Swap; // мутируем перестановкой двух бит
 	config.mutationProbability = 0.2; // 20% мутируют
 
+	config.diversityPolicy = DiversityPolicy::None; // разнообразие не отслеживается
+	config.diversityThreshold = 0.05; // 5% от разнообразия случайной популяции
+	config.diversityBoost = 5; // вероятность мутации повышается в 5 раз
+
+	config.memeticElites = 0; // локальный поиск отключён
+	config.memeticBudget = 100; // до 100 вычислений функции за эпоху
+
+	config.algorithmType = AlgorithmType::Generational; // поколенческий алгоритм
+	config.replacementType = ReplacementType::Worst; // замещаем худшую особь
+
+	config.seed = time(0); // без явного значения каждый запуск уникален
+
+	config.threads = 1; // оцениваем в одном потоке
+	config.parallelThreshold = 256; // маленькие популяции оцениваем последовательно
+
+	config.cacheSize = 0; // кэш отключён
+
+	config.islands = 1; // одна популяция без миграции
+	config.migrationInterval = 10; // миграция раз в 10 эпох
+	config.migrationSize = 2; // мигрируют две лучших особи
+	config.migrationTopology = MigrationTopology::Ring; // миграция по кольцу
+	config.pinThreads = false; // потоки не привязываются к ядрам
+	config.islandMode = IslandMode::Threads; // острова в потоках одного процесса
+
+	config.telemetryFormat = TelemetryFormat::None; // телеметрия отключена
+	config.telemetryPath = "telemetry.csv";
+	config.telemetryPopulation = false; // только показатели эпох
+	config.telemetryBuffer = 1024; // буфер на 1024 эпохи
+
+	config.checkpointPath = ""; // снимки не сохраняются
+	config.checkpointInterval = 10; // снимок раз в 10 эпох
+	config.resume = false; // начинаем с новой популяции
+
+	config.sweepMode = SweepMode::None; // без перебора параметров
+	config.sweepSamples = 10; // 10 случайных сочетаний
+	config.sweepSeeds = 1; // один запуск на сочетание
+	config.sweepThreads = 1; // перебор в одном потоке
+
+	config.function = ""; // функция из main.cpp
+	config.objectives = 1; // одна цель
+	config.paretoPath = ""; // фронт только выводится
+	config.pluginPath = ""; // функция из main.cpp
+	config.pluginArgs = "";
+
 	config.debug = false; // отключает отладку
 	
 	EvalConfig(config);
@@ -137,9 +302,27 @@ void PrintMutationType(MutationType type) {
 	}
 }
 
+void PrintMigrationTopology(MigrationTopology topology) {
+	switch (topology) {
+		case MigrationTopology::Ring:
+			std::cout << "ring";
+			break;
+
+		case MigrationTopology::Random:
+			std::cout << "random";
+			break;
+	}
+}
+
 void PrintConfig(Config config) {
 	std::cout << "mode: " << config.mode << std::endl;
-	std::cout << "search space: [" << config.leftBorder << ", " << config.rightBorder << "]" << std::endl;
+	std::cout << "search space: ";
+
+	for (size_t i = 0; i < config.dimensions; i++)
+		std::cout << (i > 0 ? " x " : "") << "[" << config.leftBorders[i] << ", " << config.rightBorders[i] << "]";
+
+	std::cout << std::endl;
+	std::cout << "genome bits: " << config.genomeBits << std::endl;
 	std::cout << std::endl;
 	std::cout << "population size: " << config.populationSize << std::endl;
 	std::cout << std::endl;
@@ -151,6 +334,9 @@ void PrintConfig(Config config) {
 	std::cout << "selection: ";
 	PrintSelectionType(config.selectionType);
 	std::cout << std::endl;
+	if (config.selectionType == SelectionType::Tournament)
+		std::cout << "tournament size: " << config.tournamentSize << std::endl;
+
 	std::cout << "selection size: " << config.selectionSize << std::endl;
 	std::cout << std::endl;
 
@@ -161,4 +347,47 @@ void PrintConfig(Config config) {
 	std::cout << "mutation: ";
 	PrintMutationType(config.mutationType);
 	std::cout << " (" << config.mutationProbability << ")" << std::endl;
+	std::cout << std::endl;
+
+	if (config.diversityPolicy != DiversityPolicy::None) {
+		std::cout << "diversity policy: ";
+
+		if (config.diversityPolicy == DiversityPolicy::Mutation)
+			std::cout << "mutation x" << config.diversityBoost;
+		else
+			std::cout << "restart";
+
+		std::cout << " below " << config.diversityThreshold << std::endl;
+		std::cout << std::endl;
+	}
+
+	if (config.memeticElites > 0) {
+		std::cout << "memetic: " << config.memeticElites << " elites, " << config.memeticBudget << " evaluations per epoch" << std::endl;
+		std::cout << std::endl;
+	}
+
+	if (config.algorithmType == AlgorithmType::SteadyState) {
+		std::cout << "algorithm: steady state (replacement: " << (config.replacementType == ReplacementType::Worst ? "worst" : "tournament") << ")" << std::endl;
+		std::cout << std::endl;
+	}
+	else if (config.algorithmType == AlgorithmType::Nsga2) {
+		std::cout << "algorithm: nsga2 (objectives: " << config.objectives << ")" << std::endl;
+		std::cout << std::endl;
+	}
+
+	std::cout << "seed: " << config.seed << std::endl;
+	std::cout << "threads: " << config.threads << " (parallel threshold: " << config.parallelThreshold << ")" << std::endl;
+	std::cout << "cache size: " << config.cacheSize << std::endl;
+
+	if (config.function != "")
+		std::cout << "function: " << config.function << std::endl;
+
+	if (config.pluginPath != "")
+		std::cout << "plugin: " << config.pluginPath << (config.pluginArgs != "" ? " (" + config.pluginArgs + ")" : "") << std::endl;
+
+	if (config.islands > 1) {
+		std::cout << "islands: " << config.islands << (config.islandMode == IslandMode::Processes ? " processes" : " threads") << " (migration: ";
+		PrintMigrationTopology(config.migrationTopology);
+		std::cout << ", " << config.migrationSize << " every " << config.migrationInterval << " epochs)" << std::endl;
+	}
 }
\ No newline at end of file
@@ -3,13 +3,22 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <thread>
 #include "Config.hpp"
+#include "Expression.hpp"
 
 class ConfigParser {
 	std::string GetText(const std::string& line, size_t &start); // получение текста
+	std::vector<double> GetNumbers(const std::string& value); // получение списка чисел через запятую
+	std::string GetExpression(const std::string& line); // получение выражения: всё значение до комментария, включая пробелы
 	void ProcessLine(const std::string& line, Config &config); // обработка строки файла
+	bool ProcessIslandLine(const std::string& line, Config &config); // обработка параметра отдельного острова
+	bool ProcessSweepLine(const std::string& line, Config &config); // обработка перебираемого параметра
+	bool IsIslandCompatible(const Config &config) const; // поддерживает ли цикл эпох островов параметры конфигурации
 public:
 	Config Parse(const std::string& path);
+	Config GetIslandConfig(const Config &config, size_t island); // получение конфигурации острова
+	Config GetSweepConfig(const Config &config, const std::vector<std::string> &lines); // получение конфигурации сочетания перебираемых параметров
 };
 
 // получение текста
@@ -20,6 +29,12 @@ std::string ConfigParser::GetText(const std::string& line, size_t &start) {
 
 	std::string text = "";
 
+	// комментарий после пустого значения (например, "checkpoint_path = # ...") не является значением
+	if (start < line.length() && line[start] == '#') {
+		start = line.length();
+		return text;
+	}
+
 	// наращиваем строку до конца, до пробела или равенства
 	while (start < line.length() && line[start] != ' ' && line[start] != '=') {
 		text += line[start];
@@ -29,6 +44,41 @@ std::string ConfigParser::GetText(const std::string& line, size_t &start) {
 	return text;
 }
 
+// получение списка чисел через запятую
+std::vector<double> ConfigParser::GetNumbers(const std::string& value) {
+	std::vector<double> numbers;
+	size_t start = 0;
+
+	while (start <= value.length()) {
+		size_t end = value.find(',', start);
+
+		if (end == std::string::npos)
+			end = value.length();
+
+		numbers.push_back(std::stod(value.substr(start, end - start)));
+		start = end + 1;
+	}
+
+	return numbers;
+}
+
+// получение выражения: всё значение до комментария, включая пробелы
+std::string ConfigParser::GetExpression(const std::string& line) {
+	size_t start = line.find('=');
+	size_t end = line.find('#');
+
+	if (start == std::string::npos)
+		return "";
+
+	std::string expression = line.substr(start + 1, end == std::string::npos ? std::string::npos : end - start - 1);
+	size_t first = expression.find_first_not_of(' ');
+
+	if (first == std::string::npos)
+		return "";
+
+	return expression.substr(first, expression.find_last_not_of(' ') - first + 1);
+}
+
 // обработка строки файла
 void ConfigParser::ProcessLine(const std::string& line, Config &config) {
 	size_t i = 0;
@@ -42,10 +92,26 @@ void ConfigParser::ProcessLine(const std::string& line, Config &config) {
 		config.mode = value;
 	}
 	else if (key == "left_border" || key == "left" || key == "a") {
-		config.leftBorder = std::stod(value);
+		config.leftBorders = GetNumbers(value);
 	}
 	else if (key == "right_border" || key == "right" || key == "b") {
-		config.rightBorder = std::stod(value);
+		config.rightBorders = GetNumbers(value);
+	}
+	else if (key == "dimensions" || key == "dimension" || key == "n") {
+		int dimensions = std::stoi(value);
+
+		if (dimensions < 1)
+			throw std::runtime_error("invalid dimensions value '" + value + "'");
+
+		config.dimensions = dimensions;
+	}
+	else if (key == "genome_bits" || key == "bits") {
+		int bits = std::stoi(value);
+
+		if (bits != 16 && bits != 30 && bits != 32 && bits != 64 && bits != 128 && bits != 256)
+			throw std::runtime_error("unsupported genome bits value '" + value + "' (supported: 16, 30, 32, 64, 128, 256)");
+
+		config.genomeBits = bits;
 	}
 	else if (key == "population_size") {
 		config.populationSize = std::stoi(value);
@@ -89,6 +155,14 @@ void ConfigParser::ProcessLine(const std::string& line, Config &config) {
 		else
 			throw std::runtime_error("unknown selection type '" + value + "'");
 	}
+	else if (key == "tournament_size") {
+		int tournamentSize = std::stoi(value);
+
+		if (tournamentSize < 1)
+			throw std::runtime_error("invalid tournament size value '" + value + "'");
+
+		config.tournamentSize = tournamentSize;
+	}
 	else if (key == "selection_part") {
 		config.selectionPart = std::stod(value);
 
@@ -121,6 +195,246 @@ void ConfigParser::ProcessLine(const std::string& line, Config &config) {
 		if (config.mutationProbability <= 0 || config.mutationProbability > 1)
 			throw std::runtime_error("invalid mutation probability value '" + value + "'");
 	}
+	else if (key == "diversity_policy" || key == "diversity") {
+		if (value == "none")
+			config.diversityPolicy = DiversityPolicy::None;
+		else if (value == "mutation")
+			config.diversityPolicy = DiversityPolicy::Mutation;
+		else if (value == "restart")
+			config.diversityPolicy = DiversityPolicy::Restart;
+		else
+			throw std::runtime_error("unknown diversity policy '" + value + "'");
+	}
+	else if (key == "diversity_threshold") {
+		config.diversityThreshold = std::stod(value);
+
+		if (config.diversityThreshold <= 0 || config.diversityThreshold > 1)
+			throw std::runtime_error("invalid diversity threshold value '" + value + "'");
+	}
+	else if (key == "diversity_boost") {
+		config.diversityBoost = std::stod(value);
+
+		if (config.diversityBoost < 1)
+			throw std::runtime_error("invalid diversity boost value '" + value + "'");
+	}
+	else if (key == "memetic_elites") {
+		int memeticElites = std::stoi(value);
+
+		if (memeticElites < 0)
+			throw std::runtime_error("invalid memetic elites value '" + value + "'");
+
+		config.memeticElites = memeticElites;
+	}
+	else if (key == "memetic_budget") {
+		int memeticBudget = std::stoi(value);
+
+		if (memeticBudget < 1)
+			throw std::runtime_error("invalid memetic budget value '" + value + "'");
+
+		config.memeticBudget = memeticBudget;
+	}
+	else if (key == "algorithm") {
+		if (value == "generational")
+			config.algorithmType = AlgorithmType::Generational;
+		else if (value == "steady_state")
+			config.algorithmType = AlgorithmType::SteadyState;
+		else if (value == "nsga2")
+			config.algorithmType = AlgorithmType::Nsga2;
+		else
+			throw std::runtime_error("unknown algorithm '" + value + "'");
+	}
+	else if (key == "replacement") {
+		if (value == "worst")
+			config.replacementType = ReplacementType::Worst;
+		else if (value == "tournament")
+			config.replacementType = ReplacementType::Tournament;
+		else
+			throw std::runtime_error("unknown replacement '" + value + "'");
+	}
+	else if (key == "seed") {
+		config.seed = std::stoull(value);
+	}
+	else if (key == "threads") {
+		int threads = std::stoi(value);
+
+		if (threads < 0)
+			throw std::runtime_error("invalid threads value '" + value + "'");
+
+		config.threads = threads == 0 ? std::thread::hardware_concurrency() : threads; // 0 - по числу ядер
+
+		if (config.threads == 0)
+			config.threads = 1;
+	}
+	else if (key == "parallel_threshold") {
+		int threshold = std::stoi(value);
+
+		if (threshold < 0)
+			throw std::runtime_error("invalid parallel threshold value '" + value + "'");
+
+		config.parallelThreshold = threshold;
+	}
+	else if (key == "cache_size") {
+		int cacheSize = std::stoi(value);
+
+		if (cacheSize < 0)
+			throw std::runtime_error("invalid cache size value '" + value + "'");
+
+		config.cacheSize = cacheSize;
+	}
+	else if (key == "islands") {
+		int islands = std::stoi(value);
+
+		if (islands < 1)
+			throw std::runtime_error("invalid islands value '" + value + "'");
+
+		config.islands = islands;
+	}
+	else if (key == "migration_interval") {
+		int interval = std::stoi(value);
+
+		if (interval < 1)
+			throw std::runtime_error("invalid migration interval value '" + value + "'");
+
+		config.migrationInterval = interval;
+	}
+	else if (key == "migration_size") {
+		int size = std::stoi(value);
+
+		if (size < 1)
+			throw std::runtime_error("invalid migration size value '" + value + "'");
+
+		config.migrationSize = size;
+	}
+	else if (key == "migration_topology" || key == "migration") {
+		if (value == "ring")
+			config.migrationTopology = MigrationTopology::Ring;
+		else if (value == "random")
+			config.migrationTopology = MigrationTopology::Random;
+		else
+			throw std::runtime_error("unknown migration topology '" + value + "'");
+	}
+	else if (key == "island_mode") {
+		if (value == "threads")
+			config.islandMode = IslandMode::Threads;
+		else if (value == "processes")
+			config.islandMode = IslandMode::Processes;
+		else
+			throw std::runtime_error("unknown island mode '" + value + "'");
+	}
+	else if (key == "pin_threads") {
+		if (value == "true" || value == "") {
+			config.pinThreads = true;
+		}
+		else if (value == "false") {
+			config.pinThreads = false;
+		}
+		else {
+			throw std::runtime_error("invalid pin threads value '" + value + "'");
+		}
+	}
+	else if (key == "telemetry") {
+		if (value == "none")
+			config.telemetryFormat = TelemetryFormat::None;
+		else if (value == "csv")
+			config.telemetryFormat = TelemetryFormat::Csv;
+		else if (value == "jsonl")
+			config.telemetryFormat = TelemetryFormat::JsonLines;
+		else
+			throw std::runtime_error("unknown telemetry format '" + value + "'");
+	}
+	else if (key == "telemetry_path") {
+		config.telemetryPath = value;
+	}
+	else if (key == "telemetry_population") {
+		if (value == "true" || value == "") {
+			config.telemetryPopulation = true;
+		}
+		else if (value == "false") {
+			config.telemetryPopulation = false;
+		}
+		else {
+			throw std::runtime_error("invalid telemetry population value '" + value + "'");
+		}
+	}
+	else if (key == "telemetry_buffer") {
+		int size = std::stoi(value);
+
+		if (size < 1)
+			throw std::runtime_error("invalid telemetry buffer value '" + value + "'");
+
+		config.telemetryBuffer = size;
+	}
+	else if (key == "checkpoint_path" || key == "checkpoint") {
+		config.checkpointPath = value;
+	}
+	else if (key == "checkpoint_interval") {
+		int interval = std::stoi(value);
+
+		if (interval < 1)
+			throw std::runtime_error("invalid checkpoint interval value '" + value + "'");
+
+		config.checkpointInterval = interval;
+	}
+	else if (key == "resume") {
+		if (value == "true" || value == "") {
+			config.resume = true;
+		}
+		else if (value == "false") {
+			config.resume = false;
+		}
+		else {
+			throw std::runtime_error("invalid resume value '" + value + "'");
+		}
+	}
+	else if (key == "sweep") {
+		if (value == "none")
+			config.sweepMode = SweepMode::None;
+		else if (value == "grid")
+			config.sweepMode = SweepMode::Grid;
+		else if (value == "random")
+			config.sweepMode = SweepMode::Random;
+		else
+			throw std::runtime_error("unknown sweep mode '" + value + "'");
+	}
+	else if (key == "sweep_samples") {
+		int samples = std::stoi(value);
+
+		if (samples < 1)
+			throw std::runtime_error("invalid sweep samples value '" + value + "'");
+
+		config.sweepSamples = samples;
+	}
+	else if (key == "sweep_seeds") {
+		int seeds = std::stoi(value);
+
+		if (seeds < 1)
+			throw std::runtime_error("invalid sweep seeds value '" + value + "'");
+
+		config.sweepSeeds = seeds;
+	}
+	else if (key == "sweep_threads") {
+		int threads = std::stoi(value);
+
+		if (threads < 0)
+			throw std::runtime_error("invalid sweep threads value '" + value + "'");
+
+		config.sweepThreads = threads == 0 ? std::thread::hardware_concurrency() : threads; // 0 - по числу ядер
+
+		if (config.sweepThreads == 0)
+			config.sweepThreads = 1;
+	}
+	else if (key == "function") {
+		config.function = GetExpression(line);
+	}
+	else if (key == "pareto_path" || key == "pareto") {
+		config.paretoPath = value;
+	}
+	else if (key == "plugin") {
+		config.pluginPath = value;
+	}
+	else if (key == "plugin_args") {
+		config.pluginArgs = value;
+	}
 	else if (key == "debug") {
 		if (value == "true" || value == "") {
 			config.debug = true;
@@ -137,6 +451,91 @@ void ConfigParser::ProcessLine(const std::string& line, Config &config) {
 	}
 }
 
+// обработка параметра отдельного острова вида islandN.key = value
+bool ConfigParser::ProcessIslandLine(const std::string& line, Config &config) {
+	size_t i = 0;
+	std::string key = GetText(line, i);
+	size_t dot = key.find('.');
+
+	if (key.compare(0, 6, "island") != 0 || dot == std::string::npos || dot == 6)
+		return false;
+
+	std::string index = key.substr(6, dot - 6);
+
+	if (index.find_first_not_of("0123456789") != std::string::npos)
+		throw std::runtime_error("invalid island index '" + index + "'");
+
+	// строка применяется позже поверх общей конфигурации, поэтому порядок параметров в файле не важен
+	config.islandSettings.push_back(std::make_pair(std::stoul(index), line.substr(line.find('.') + 1)));
+	return true;
+}
+
+// поддерживает ли цикл эпох островов параметры конфигурации: острова не применяют политику разнообразия,
+// не пишут телеметрию и снимки, поэтому такие параметры отклоняются, а не игнорируются молча
+bool ConfigParser::IsIslandCompatible(const Config &config) const {
+	return config.diversityPolicy == DiversityPolicy::None && config.telemetryFormat == TelemetryFormat::None && config.checkpointPath == "" && !config.resume;
+}
+
+// обработка перебираемого параметра вида sweep.key = value1,value2,...
+bool ConfigParser::ProcessSweepLine(const std::string& line, Config &config) {
+	size_t i = 0;
+	std::string key = GetText(line, i);
+
+	if (key.compare(0, 6, "sweep.") != 0)
+		return false;
+
+	std::string name = key.substr(6);
+	std::string values = GetText(line, i);
+
+	if (name == "" || values == "")
+		throw std::runtime_error("invalid sweep parameter '" + key + "'");
+
+	config.sweepSettings.push_back(std::make_pair(name, values));
+	return true;
+}
+
+// получение конфигурации острова: общие параметры с переопределениями для этого острова
+Config ConfigParser::GetIslandConfig(const Config &config, size_t island) {
+	Config islandConfig = config;
+
+	for (size_t i = 0; i < config.islandSettings.size(); i++)
+		if (config.islandSettings[i].first == island)
+			ProcessLine(config.islandSettings[i].second, islandConfig);
+
+	EvalConfig(islandConfig);
+
+	// мигранты переносятся между островами как есть, поэтому пространство поиска должно совпадать
+	if (islandConfig.mode != config.mode || islandConfig.dimensions != config.dimensions || islandConfig.genomeBits != config.genomeBits || islandConfig.leftBorders != config.leftBorders || islandConfig.rightBorders != config.rightBorders)
+		throw std::runtime_error("island " + std::to_string(island) + " must have the same mode, borders, dimensions and genome bits");
+
+	if (islandConfig.islands != config.islands || islandConfig.islandMode != config.islandMode)
+		throw std::runtime_error("islands and island mode can not be set for a single island");
+
+	if (config.islands > 1 && !IsIslandCompatible(islandConfig))
+		throw std::runtime_error("islands can not be combined with diversity policy, telemetry, checkpoints or resume");
+
+	return islandConfig;
+}
+
+// получение конфигурации сочетания: общие параметры с подставленными строками вида key = value
+Config ConfigParser::GetSweepConfig(const Config &config, const std::vector<std::string> &lines) {
+	Config sweepConfig = config;
+
+	for (size_t i = 0; i < lines.size(); i++)
+		ProcessLine(lines[i], sweepConfig);
+
+	EvalConfig(sweepConfig);
+
+	// размер генома выбирается при компиляции один раз на весь перебор
+	if (sweepConfig.genomeBits != config.genomeBits || sweepConfig.dimensions != config.dimensions)
+		throw std::runtime_error("genome bits and dimensions can not be swept");
+
+	if (sweepConfig.islands != 1 || sweepConfig.sweepMode != config.sweepMode || sweepConfig.algorithmType != AlgorithmType::Generational)
+		throw std::runtime_error("islands, algorithm and sweep parameters can not be swept");
+
+	return sweepConfig;
+}
+
 Config ConfigParser::Parse(const std::string& path) {
 	std::ifstream f(path);
 	Config config = GetDefaultConfig();
@@ -153,11 +552,51 @@ Config ConfigParser::Parse(const std::string& path) {
 		if (line == "" || line[0] == '#') // игнорируем комментарии
 			continue;
 
-		ProcessLine(line, config); // обрабатываем очередную строку файла
+		if (!ProcessIslandLine(line, config) && !ProcessSweepLine(line, config))
+			ProcessLine(line, config); // обрабатываем очередную строку файла
 	}
 
 	f.close(); // закрываем файл
 	EvalConfig(config); // обрабатываем конфиг
 
+	for (size_t i = 0; i < config.islandSettings.size(); i++)
+		if (config.islandSettings[i].first >= config.islands)
+			throw std::runtime_error("island " + std::to_string(config.islandSettings[i].first) + " does not exist");
+
+	if (config.sweepMode != SweepMode::None && config.sweepSettings.empty())
+		throw std::runtime_error("sweep requires at least one sweep.key = values line");
+
+	if (config.sweepMode != SweepMode::None && config.islands > 1)
+		throw std::runtime_error("sweep can not be combined with islands");
+
+	if (config.islands > 1 && !IsIslandCompatible(config))
+		throw std::runtime_error("islands can not be combined with diversity policy, telemetry, checkpoints or resume");
+
+	if (config.algorithmType == AlgorithmType::SteadyState && config.diversityPolicy == DiversityPolicy::Restart)
+		throw std::runtime_error("diversity restart is not supported by steady state algorithm");
+
+	// локальный поиск выполняется между отбором и скрещиванием, которых нет у стационарного алгоритма и NSGA-II
+	if (config.memeticElites > 0 && config.algorithmType != AlgorithmType::Generational)
+		throw std::runtime_error("memetic mode is supported only by generational algorithm");
+
+	if (config.function != "" && config.pluginPath != "")
+		throw std::runtime_error("function and plugin can not be set together");
+
+	// ошибки в выражении сообщаются до запуска
+	if (config.function != "")
+		config.objectives = Expression(config.function, config.dimensions).GetOutputs();
+
+	if (config.objectives > 1 && config.algorithmType != AlgorithmType::Nsga2)
+		throw std::runtime_error("several objectives require algorithm = nsga2");
+
+	if (config.algorithmType == AlgorithmType::Nsga2 && config.objectives < 2)
+		throw std::runtime_error("nsga2 requires function with several objectives separated by ';'");
+
+	if (config.algorithmType == AlgorithmType::Nsga2 && (config.islands > 1 || config.sweepMode != SweepMode::None || config.resume || config.diversityPolicy != DiversityPolicy::None))
+		throw std::runtime_error("nsga2 can not be combined with islands, sweep, resume or diversity policy");
+
+	if (config.algorithmType == AlgorithmType::SteadyState && (config.islands > 1 || config.sweepMode != SweepMode::None || config.resume))
+		throw std::runtime_error("steady state algorithm can not be combined with islands, sweep or resume");
+
 	return config; // возвращаем конфигурационный файл
 }
\ No newline at end of file
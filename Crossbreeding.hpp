@@ -1,85 +1,155 @@
 #pragma once
 
 #include <iostream>
+#include <algorithm>
 #include "Config.hpp"
 #include "Entity.hpp"
 
-// одноточечное скрещивание
-Entity OnePointCrossbreed(const Entity &entity1, const Entity &entity2) {
-	Entity entity; // создаём новую особь
-	unsigned point = GetRandom(M); // выбираем точку для скрещивания
-
-	// заполняем биты новой особи
-	for (int i = 0; i < M; i++) {
-		bool bit;
-
-		if (i < point)
-			bit = entity1.GetBit(i); // берём из первого родителя
-		else
-			bit = entity2.GetBit(i); // берём из второго родителя
+// одноточечное скрещивание геномов: биты младше point берутся из первого родителя
+template <unsigned Bits>
+Genome<Bits> OnePointCrossbreed(const Genome<Bits> &bits1, const Genome<Bits> &bits2, unsigned point) {
+	Genome<Bits> mask = Genome<Bits>::GetLowMask(point);
+	return (bits1 & mask) | (bits2 & ~mask);
+}
 
-		entity.SetBit(i, bit); // проставляем полученный бит
+// двухточечное скрещивание геномов: биты из [point1, point2] берутся из второго родителя
+template <unsigned Bits>
+Genome<Bits> TwoPointCrossbreed(const Genome<Bits> &bits1, const Genome<Bits> &bits2, unsigned point1, unsigned point2) {
+	// переставляем точки, если они не в том порядке
+	if (point1 > point2) {
+		unsigned tmp = point1;
+		point1 = point2;
+		point2 = tmp;
 	}
 
-	return entity;
+	Genome<Bits> range = Genome<Bits>::GetLowMask(point2 + 1) & ~Genome<Bits>::GetLowMask(point1);
+	return (bits1 & ~range) | (bits2 & range);
 }
 
-// двухточечное скрещивание
-Entity TwoPointCrossbreed(const Entity &entity1, const Entity &entity2) {
-	Entity entity; // создаём новую особь
-	unsigned point1 = GetRandom(M); // выбираем первую точку для скрещивания
-	unsigned point2 = GetRandom(M); // выбираем вторую точку для скрещивания
+// однородное скрещивание геномов: единичные биты маски берутся из первого родителя
+template <unsigned Bits>
+Genome<Bits> UniformCrossbreed(const Genome<Bits> &bits1, const Genome<Bits> &bits2, const Genome<Bits> &mask) {
+	return (bits1 & mask) | (bits2 & ~mask);
+}
+
+// одноточечное скрещивание особей из dimensions генов: точка point из [0, dimensions * Bits) может попасть на любой ген
+template <unsigned Bits>
+void OnePointCrossbreed(const Genome<Bits> *genes1, const Genome<Bits> *genes2, Genome<Bits> *child, size_t dimensions, size_t point) {
+	size_t gene = point / Bits; // ген, на который приходится точка
+
+	for (size_t i = 0; i < dimensions; i++) {
+		if (i < gene) {
+			child[i] = genes1[i];
+		}
+		else if (i > gene) {
+			child[i] = genes2[i];
+		}
+		else {
+			child[i] = OnePointCrossbreed(genes1[i], genes2[i], point % Bits);
+		}
+	}
+}
 
+// двухточечное скрещивание особей из dimensions генов: отрезок [point1, point2] может захватывать несколько генов
+template <unsigned Bits>
+void TwoPointCrossbreed(const Genome<Bits> *genes1, const Genome<Bits> *genes2, Genome<Bits> *child, size_t dimensions, size_t point1, size_t point2) {
 	// переставляем точки, если они не в том порядке
 	if (point1 > point2) {
-		unsigned tmp = point1;
+		size_t tmp = point1;
 		point1 = point2;
 		point2 = tmp;
 	}
 
-	// заполняем биты новой особи
-	for (int i = 0; i < M; i++) {
-		bool bit;
-
-		if (i < point1 || i > point2)
-			bit = entity1.GetBit(i); // берём из первого родителя
-		else
-			bit = entity2.GetBit(i); // берём из второго родителя
-
-		entity.SetBit(i, bit); // проставляем полученный бит
+	for (size_t i = 0; i < dimensions; i++) {
+		size_t begin = i * Bits; // номер первого бита гена
+		size_t low = point1 > begin ? std::min(point1 - begin, (size_t) Bits) : 0; // начало отрезка внутри гена
+		size_t high = point2 + 1 > begin ? std::min(point2 + 1 - begin, (size_t) Bits) : 0; // конец отрезка внутри гена
+
+		if (low < high) {
+			child[i] = TwoPointCrossbreed(genes1[i], genes2[i], low, high - 1);
+		}
+		else {
+			child[i] = genes1[i];
+		}
 	}
+}
 
-	return entity;
+// однородное скрещивание особей из dimensions генов
+template <unsigned Bits>
+void UniformCrossbreed(const Genome<Bits> *genes1, const Genome<Bits> *genes2, Genome<Bits> *child, size_t dimensions, Random &random) {
+	for (size_t i = 0; i < dimensions; i++)
+		child[i] = UniformCrossbreed(genes1[i], genes2[i], Genome<Bits>::GetRandom(random)); // случайные слова вместо случайного числа на каждый бит
 }
 
-// однородное скрещивание
-Entity UniformCrossbreed(const Entity &entity1, const Entity &entity2) {
-	Entity entity; // создаём новую особь
+// скрещивание особей из dimensions генов в зависимости от режима с записью в уже существующую особь
+template <unsigned Bits>
+void Crossbreed(const Genome<Bits> *genes1, const Genome<Bits> *genes2, Genome<Bits> *child, size_t dimensions, CrossbreedingType type, Random &random) {
+	unsigned length = dimensions * Bits; // общее число бит особи
 
-	// заполняем биты новой особи
-	for (int i = 0; i < M; i++) {
-		bool bit;
+	if (type == CrossbreedingType::OnePoint) {
+		OnePointCrossbreed(genes1, genes2, child, dimensions, random.GetInt(length));
+	}
+	else if (type == CrossbreedingType::TwoPoint) {
+		size_t point1 = random.GetInt(length); // выбираем первую точку для скрещивания
+		size_t point2 = random.GetInt(length); // выбираем вторую точку для скрещивания
+		TwoPointCrossbreed(genes1, genes2, child, dimensions, point1, point2);
+	}
+	else if (type == CrossbreedingType::Uniform) {
+		UniformCrossbreed(genes1, genes2, child, dimensions, random);
+	}
+	else
+		throw std::runtime_error("unhandled CrossbreedingType");
+}
+
+// пакетное скрещивание видом, известным при компиляции: потомок i (гены children[i * dimensions...]) получается из особей first[i] и second[i] массива genes,
+// draws - буфер под 2 * count случайных чисел
+template <CrossbreedingType Type, unsigned Bits>
+void Crossbreed(const Genome<Bits> *genes, const size_t *first, const size_t *second, Genome<Bits> *children, size_t count, size_t dimensions, Random &random, unsigned *draws) {
+	unsigned length = dimensions * Bits; // общее число бит особи
 
-		if (GetRandom() < 0.5)
-			bit = entity1.GetBit(i); // берём из первого родителя
-		else
-			bit = entity2.GetBit(i); // берём из второго родителя
+	// сначала разыгрываем все случайные числа, затем применяем ядро без ветвлений одним циклом
+	if (Type == CrossbreedingType::OnePoint) {
+		for (size_t i = 0; i < count; i++)
+			draws[i] = random.GetInt(length);
 
-		entity.SetBit(i, bit); // проставляем полученный бит
+		for (size_t i = 0; i < count; i++)
+			OnePointCrossbreed(genes + first[i] * dimensions, genes + second[i] * dimensions, children + i * dimensions, dimensions, draws[i]);
 	}
+	else if (Type == CrossbreedingType::TwoPoint) {
+		for (size_t i = 0; i < 2 * count; i++)
+			draws[i] = random.GetInt(length);
 
-	return entity;
+		for (size_t i = 0; i < count; i++)
+			TwoPointCrossbreed(genes + first[i] * dimensions, genes + second[i] * dimensions, children + i * dimensions, dimensions, draws[2 * i], draws[2 * i + 1]);
+	}
+	else {
+		// маски разыгрываются прямо в буфер потомков
+		for (size_t i = 0; i < count * dimensions; i++)
+			children[i] = Genome<Bits>::GetRandom(random);
+
+		for (size_t i = 0; i < count; i++) {
+			const Genome<Bits> *genes1 = genes + first[i] * dimensions;
+			const Genome<Bits> *genes2 = genes + second[i] * dimensions;
+			Genome<Bits> *child = children + i * dimensions;
+
+			for (size_t j = 0; j < dimensions; j++)
+				child[j] = UniformCrossbreed(genes1[j], genes2[j], child[j]);
+		}
+	}
 }
 
-Entity Crossbreed(const Entity &entity1, const Entity &entity2, CrossbreedingType type) {
-	if (type == CrossbreedingType::OnePoint)
-		return OnePointCrossbreed(entity1, entity2);
-	
-	if (type == CrossbreedingType::TwoPoint)
-		return TwoPointCrossbreed(entity1, entity2);
-
-	if (type == CrossbreedingType::Uniform)
-		return UniformCrossbreed(entity1, entity2);
-
-	throw std::runtime_error("unhandled CrossbreedingType");
-}
\ No newline at end of file
+// пакетное скрещивание в зависимости от режима: вид выбирается один раз на весь пакет
+template <unsigned Bits>
+void Crossbreed(const Genome<Bits> *genes, const size_t *first, const size_t *second, Genome<Bits> *children, size_t count, size_t dimensions, CrossbreedingType type, Random &random, unsigned *draws) {
+	if (type == CrossbreedingType::OnePoint) {
+		Crossbreed<CrossbreedingType::OnePoint>(genes, first, second, children, count, dimensions, random, draws);
+	}
+	else if (type == CrossbreedingType::TwoPoint) {
+		Crossbreed<CrossbreedingType::TwoPoint>(genes, first, second, children, count, dimensions, random, draws);
+	}
+	else if (type == CrossbreedingType::Uniform) {
+		Crossbreed<CrossbreedingType::Uniform>(genes, first, second, children, count, dimensions, random, draws);
+	}
+	else
+		throw std::runtime_error("unhandled CrossbreedingType");
+}
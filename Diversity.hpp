@@ -0,0 +1,165 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "Genome.hpp"
+
+// разнообразие популяции по битам генов: частоты единиц в каждом бите и среднее расстояние Хэмминга между парами особей
+// среднее расстояние выражается через частоты (сумма c * (N - c) по битам), поэтому попарное сравнение O(N^2) не нужно
+template <unsigned Bits>
+class Diversity {
+	static const unsigned Planes = 8; // число разрядов вертикальных счётчиков
+	static const size_t Chunk = (1 << Planes) - 1; // число особей, после которого счётчики сбрасываются в ones
+
+	size_t dimensions; // число генов особи
+	size_t count; // число учтённых особей
+	std::vector<size_t> ones; // число единиц в каждом бите (по 64 бита на слово гена, включая неиспользуемые старшие)
+	std::vector<uint64_t> planes; // вертикальные счётчики: разряд p счётчиков всех 64 битов слова k хранится в planes[k * Planes + p]
+
+	void Flush(); // перенос вертикальных счётчиков в ones
+	void Update(const Genome<Bits> *genes, long delta); // изменение счётчиков на delta для единиц генов одной особи
+public:
+	Diversity(size_t dimensions = 0); // создание пустой статистики
+
+	void Compute(const Genome<Bits> *genes, size_t count); // расчёт по count особям подряд за один проход
+	void Add(const Genome<Bits> *genes); // учёт добавленной особи
+	void Remove(const Genome<Bits> *genes); // исключение удалённой особи
+
+	size_t GetCount() const; // получение числа учтённых особей
+	double GetFrequency(size_t bit) const; // получение частоты единицы в бите bit (биты генов особи подряд, от младшего)
+	double GetMeanDistance() const; // получение среднего расстояния Хэмминга между парами особей
+	double GetDiversity() const; // получение среднего расстояния, отнесённого к половине числа бит особи (около 1 у случайной популяции, 0 - все особи одинаковы)
+	size_t GetFixedBits() const; // получение числа бит, одинаковых у всех особей
+};
+
+// создание пустой статистики
+template <unsigned Bits>
+Diversity<Bits>::Diversity(size_t dimensions) : dimensions(dimensions), count(0), ones(dimensions * Genome<Bits>::Words * 64, 0) {
+}
+
+// перенос вертикальных счётчиков в ones
+template <unsigned Bits>
+void Diversity<Bits>::Flush() {
+	for (size_t k = 0; k < planes.size(); k++) {
+		uint64_t plane = planes[k];
+		size_t *wordOnes = &ones[k / Planes * 64];
+
+		// перебираются только установленные биты разряда
+		while (plane) {
+			wordOnes[__builtin_ctzll(plane)] += (size_t) 1 << (k % Planes);
+			plane &= plane - 1;
+		}
+
+		planes[k] = 0;
+	}
+}
+
+// изменение счётчиков на delta для единиц генов одной особи
+template <unsigned Bits>
+void Diversity<Bits>::Update(const Genome<Bits> *genes, long delta) {
+	const uint64_t *words = genes[0].words;
+
+	for (size_t k = 0; k < dimensions * Genome<Bits>::Words; k++) {
+		for (uint64_t word = words[k]; word; word &= word - 1)
+			ones[k * 64 + __builtin_ctzll(word)] += delta;
+	}
+}
+
+// расчёт по count особям подряд за один проход: слово каждой особи прибавляется сразу к 64 счётчикам
+// сложением с переносом по разрядам (в среднем два логических действия на слово), а счётчики сбрасываются раз в Chunk особей
+template <unsigned Bits>
+void Diversity<Bits>::Compute(const Genome<Bits> *genes, size_t count) {
+	size_t words = dimensions * Genome<Bits>::Words;
+	const uint64_t *data = genes[0].words; // гены особей хранятся подряд
+
+	this->count = count;
+	ones.assign(words * 64, 0);
+	planes.assign(words * Planes, 0);
+
+	for (size_t start = 0; start < count; start += Chunk) {
+		size_t end = std::min(count, start + Chunk);
+
+		for (size_t i = start; i < end; i++) {
+			const uint64_t *entity = data + i * words;
+
+			for (size_t k = 0; k < words; k++) {
+				uint64_t *plane = &planes[k * Planes];
+				uint64_t carry = entity[k];
+
+				for (unsigned p = 0; carry; p++) {
+					uint64_t next = plane[p] & carry;
+					plane[p] ^= carry;
+					carry = next;
+				}
+			}
+		}
+
+		Flush();
+	}
+}
+
+// учёт добавленной особи
+template <unsigned Bits>
+void Diversity<Bits>::Add(const Genome<Bits> *genes) {
+	Update(genes, 1);
+	count++;
+}
+
+// исключение удалённой особи
+template <unsigned Bits>
+void Diversity<Bits>::Remove(const Genome<Bits> *genes) {
+	Update(genes, -1);
+	count--;
+}
+
+// получение числа учтённых особей
+template <unsigned Bits>
+size_t Diversity<Bits>::GetCount() const {
+	return count;
+}
+
+// получение частоты единицы в бите bit (биты генов особи подряд, от младшего)
+template <unsigned Bits>
+double Diversity<Bits>::GetFrequency(size_t bit) const {
+	size_t gene = bit / Bits;
+	size_t index = bit % Bits;
+
+	return count > 0 ? (double) ones[gene * Genome<Bits>::Words * 64 + index] / count : 0;
+}
+
+// получение среднего расстояния Хэмминга между парами особей: бит с c единицами различается у c * (N - c) пар
+template <unsigned Bits>
+double Diversity<Bits>::GetMeanDistance() const {
+	if (count < 2)
+		return 0;
+
+	double pairs = 0;
+
+	for (size_t i = 0; i < ones.size(); i++)
+		pairs += (double) ones[i] * (count - ones[i]);
+
+	return pairs / (count * (count - 1) / 2.0);
+}
+
+// получение среднего расстояния, отнесённого к половине числа бит особи
+template <unsigned Bits>
+double Diversity<Bits>::GetDiversity() const {
+	return dimensions > 0 ? GetMeanDistance() / (dimensions * Bits / 2.0) : 0;
+}
+
+// получение числа бит, одинаковых у всех особей
+template <unsigned Bits>
+size_t Diversity<Bits>::GetFixedBits() const {
+	size_t fixed = 0;
+
+	for (size_t gene = 0; gene < dimensions; gene++)
+		for (size_t index = 0; index < Bits; index++) {
+			size_t c = ones[gene * Genome<Bits>::Words * 64 + index];
+			fixed += c == 0 || c == count;
+		}
+
+	return fixed;
+}
@@ -1,94 +1,106 @@
 #pragma once
 
 #include <iostream>
-#include <ctime>
-#include <random>
+#include <vector>
+#include <cmath>
+#include "Config.hpp"
+#include "Genome.hpp"
+
+// получение шага декодирования (b - a) / 2^Bits (точно, так как 2^Bits - степень двойки)
+template <unsigned Bits>
+double GetDecodeStep(double a, double b) {
+	return (b - a) * std::ldexp(1.0, -(int) Bits);
+}
+
+// декодирование генов особи в точку пространства поиска
+template <unsigned Bits>
+void Decode(const Config &config, const Genome<Bits> *genes, double *x) {
+	for (size_t i = 0; i < config.dimensions; i++)
+		x[i] = genes[i].Decode(config.leftBorders[i], GetDecodeStep<Bits>(config.leftBorders[i], config.rightBorders[i]));
+}
 
-const unsigned M = 30; // число бит генома
-const unsigned TwoM = 1 << M; // максимальное значение генома
+// вывод генов особи
+template <unsigned Bits>
+void PrintGenes(std::ostream &os, const Genome<Bits> *genes, size_t dimensions) {
+	for (size_t d = 0; d < dimensions; d++) {
+		if (d > 0)
+			os << "| ";
 
-std::mt19937 generator(time(0));
-std::uniform_int_distribution<unsigned> distribution(0, TwoM);
-std::uniform_real_distribution<double> realDistribution(0.0, 1.0);
+		// выводим биты слева направо
+		for (unsigned i = Bits; i > 0; i--)
+			os << genes[d].GetBit(i - 1) << " ";
+	}
+}
 
+// особь, извлечённая из популяции: гены всех измерений и оценка
+template <unsigned Bits>
 class Entity {
-	unsigned bits; // битовое представление особи
+	std::vector<Genome<Bits>> genes; // гены по измерениям
 	double score; // приспособленность
 public:
-	Entity(); // создание особи
+	Entity(); // создание пустой особи
+	Entity(const Genome<Bits> *genes, size_t dimensions, double score); // создание особи по генам и оценке
 
-	double Eval(double a, double b) const; // получение численного значения особи
-	void Score(double (*f)(double), double a, double b); // оценка приспособленности
-	double GetScore() const; // получение оценки приспособленности
+	void Assign(const Genome<Bits> *genes, size_t dimensions, double score); // замена генов и оценки (память генов используется повторно)
 
-	void InverseBit(int index); // инверсия бита по индексу
-	bool GetBit(int index) const; // получение бита по индексу
-	void SetBit(int index, bool bit); // установка бита по индексу
+	size_t GetDimensions() const; // получение числа измерений
+	const Genome<Bits>* GetGenes() const; // получение генов
+	double GetScore() const; // получение оценки приспособленности
+	std::vector<double> Eval(const Config &config) const; // получение точки пространства поиска
 
-	friend std::ostream& operator<<(std::ostream& os, const Entity& entity); // вывод особи
+	template <unsigned B>
+	friend std::ostream& operator<<(std::ostream& os, const Entity<B>& entity); // вывод особи
 };
 
-double GetRandom() {
-	return realDistribution(generator);
-}
-
-unsigned GetRandom(unsigned maxValue) {
-	return distribution(generator) % maxValue;
+// создание пустой особи
+template <unsigned Bits>
+Entity<Bits>::Entity() {
+	score = 0;
 }
 
-unsigned GetRandom(unsigned minValue, unsigned maxValue) {
-	return minValue + distribution(generator) % (maxValue - minValue);
+// создание особи по генам и оценке
+template <unsigned Bits>
+Entity<Bits>::Entity(const Genome<Bits> *genes, size_t dimensions, double score) : genes(genes, genes + dimensions) {
+	this->score = score;
 }
 
-// создание особи
-Entity::Entity() {
-	bits = GetRandom(TwoM); // генерируем случайные биты
-	score = 0;
+// замена генов и оценки (память генов используется повторно)
+template <unsigned Bits>
+void Entity<Bits>::Assign(const Genome<Bits> *genes, size_t dimensions, double score) {
+	this->genes.assign(genes, genes + dimensions);
+	this->score = score;
 }
 
-// получение численного значения особи
-double Entity::Eval(double a, double b) const {
-	return a + bits * (b - a) / TwoM;
+// получение числа измерений
+template <unsigned Bits>
+size_t Entity<Bits>::GetDimensions() const {
+	return genes.size();
 }
 
-// оценка приспособленности
-void Entity::Score(double (*f)(double), double a, double b) {
-	double x = Eval(a, b); // получаем вещественное представление особи
-	score = f(x); // вычисляем значение функции
+// получение генов
+template <unsigned Bits>
+const Genome<Bits>* Entity<Bits>::GetGenes() const {
+	return genes.data();
 }
 
 // получение оценки приспособленности
-double Entity::GetScore() const {
+template <unsigned Bits>
+double Entity<Bits>::GetScore() const {
 	return score;
 }
 
-// инверсия бита по индексу
-void Entity::InverseBit(int index) {
-	bits ^= 1 << index;
-}
-
-// получение бита по индексу
-bool Entity::GetBit(int index) const {
-	return (bits >> index) & 1;
-}
-
-// установка бита по индексу
-void Entity::SetBit(int index, bool bit) {
-	if (bit) {
-		bits |= 1 << index;
-	}
-	else {
-		bits &= ~(1 << index);
-	}
+// получение точки пространства поиска
+template <unsigned Bits>
+std::vector<double> Entity<Bits>::Eval(const Config &config) const {
+	std::vector<double> x(genes.size());
+	Decode(config, genes.data(), x.data());
+	return x;
 }
 
 // вывод особи
-std::ostream& operator<<(std::ostream& os, const Entity& entity) {
+template <unsigned Bits>
+std::ostream& operator<<(std::ostream& os, const Entity<Bits>& entity) {
 	os << "entity: " << entity.score << ", bits: [";
-
-	// выводим биты слева направо
-	for (int i = M - 1; i >= 0; i--)
-		os << ((entity.bits >> i) & 1) << " ";
-
-	return os << "] (int value: " << entity.bits << ")";
-}
\ No newline at end of file
+	PrintGenes(os, entity.genes.data(), entity.genes.size());
+	return os << "]";
+}
@@ -0,0 +1,516 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <stdexcept>
+
+// код операции байткода
+enum class ExpressionCode {
+	Add, Sub, Mul, Div, Pow, Min, Max, // двуместные
+	Neg, Sin, Cos, Tan, Asin, Acos, Atan, Exp, Log, Sqrt, Abs, Floor // одноместные
+};
+
+// операнд инструкции: константа или регистр
+struct ExpressionOperand {
+	bool constant; // является ли операнд константой
+	double value; // значение константы
+	size_t reg; // номер регистра
+};
+
+// инструкция: dst = code(a, b), у одноместных операций b не используется
+struct ExpressionInstruction {
+	ExpressionCode code; // код операции
+	size_t dst; // регистр результата
+	ExpressionOperand a; // первый операнд
+	ExpressionOperand b; // второй операнд
+};
+
+// выражение оценочной функции, заданное строкой, например "x*sin(x+5)*cos(x-6)"
+// выражение один раз компилируется в байткод с регистрами, причём подвыражения из констант вычисляются при компиляции,
+// а каждая инструкция выполняется сразу над блоком из BLOCK точек: за проход по популяции выбор операции
+// происходит один раз на инструкцию и блок, а не на каждую особь, и внутренние циклы простых операций векторизуются
+// переменные: x1, ..., xN - координаты точки, x - текущая координата (выражение с x суммируется по всем координатам, как F в main.cpp)
+// несколько выражений через ';' задают несколько целей, которые вычисляются одной программой
+class Expression {
+	static const size_t BLOCK = 256; // число точек, обрабатываемых одним проходом программы
+
+	std::string text; // текст выражения
+	size_t dimensions; // число измерений
+	size_t position; // позиция разбора
+
+	std::vector<ExpressionInstruction> program; // программа
+	std::vector<ExpressionOperand> results; // результаты программы (по одному на цель)
+	size_t registers; // число регистров: x, x1, ..., xN, затем временные
+	std::vector<size_t> freeRegisters; // освобождённые временные регистры (только во время компиляции)
+	bool summed; // используется ли переменная x
+
+	void Error(const std::string &message) const; // ошибка разбора в текущей позиции
+	bool Accept(char c); // пропуск символа c, если он следующий
+	void Expect(char c); // пропуск обязательного символа c
+
+	ExpressionOperand Constant(double value) const; // операнд-константа
+	ExpressionOperand Register(size_t reg) const; // операнд-регистр
+	void Release(const ExpressionOperand &operand); // освобождение временного регистра
+	ExpressionOperand Emit(ExpressionCode code, const ExpressionOperand &a, const ExpressionOperand &b); // добавление инструкции со свёрткой констант
+
+	ExpressionOperand ParseSum(); // сумма и разность
+	ExpressionOperand ParseProduct(); // произведение и частное
+	ExpressionOperand ParseUnary(); // унарные плюс и минус
+	ExpressionOperand ParsePower(); // возведение в степень (правоассоциативное)
+	ExpressionOperand ParsePrimary(); // число, переменная, вызов функции или выражение в скобках
+	ExpressionOperand ParseCall(const std::string &name); // вызов функции
+
+	static double Apply(ExpressionCode code, double a, double b); // значение операции
+	void Run(double **values, size_t n) const; // выполнение программы над блоком из n точек
+public:
+	Expression(const std::string &text, size_t dimensions); // компиляция выражения
+
+	size_t GetInstructions() const; // получение числа инструкций
+	size_t GetRegisters() const; // получение числа регистров
+	size_t GetOutputs() const; // получение числа целей
+	void Evaluate(const double *x, double *scores, size_t n) const; // оценка n точек по dimensions координат подряд, цели точки i записываются в scores[i * outputs ...]
+
+	friend std::ostream& operator<<(std::ostream& os, const Expression &expression); // вывод программы
+};
+
+const size_t Expression::BLOCK;
+
+// выполнение двуместной операции над блоком, nullptr вместо массива означает константу
+template <typename Operation>
+void ExpressionBinary(double *dst, const double *a, double av, const double *b, double bv, size_t n, Operation operation) {
+	if (a && b) {
+		for (size_t i = 0; i < n; i++)
+			dst[i] = operation(a[i], b[i]);
+	}
+	else if (a) {
+		for (size_t i = 0; i < n; i++)
+			dst[i] = operation(a[i], bv);
+	}
+	else {
+		for (size_t i = 0; i < n; i++)
+			dst[i] = operation(av, b[i]);
+	}
+}
+
+// выполнение одноместной операции над блоком
+template <typename Operation>
+void ExpressionUnary(double *dst, const double *a, size_t n, Operation operation) {
+	for (size_t i = 0; i < n; i++)
+		dst[i] = operation(a[i]);
+}
+
+// компиляция выражения
+Expression::Expression(const std::string &text, size_t dimensions) : text(text), dimensions(dimensions) {
+	position = 0;
+	registers = dimensions + 1;
+	summed = false;
+
+	// регистры результатов не освобождаются, поэтому следующие выражения их не затирают
+	do {
+		results.push_back(ParseSum());
+	} while (Accept(';'));
+
+	while (position < text.length() && isspace(text[position]))
+		position++;
+
+	if (position < text.length())
+		Error("unexpected symbol '" + text.substr(position, 1) + "'");
+
+	freeRegisters.clear();
+}
+
+// ошибка разбора в текущей позиции
+void Expression::Error(const std::string &message) const {
+	throw std::runtime_error("invalid function '" + text + "': " + message + " at position " + std::to_string(position));
+}
+
+// пропуск символа c, если он следующий
+bool Expression::Accept(char c) {
+	while (position < text.length() && isspace(text[position]))
+		position++;
+
+	if (position < text.length() && text[position] == c) {
+		position++;
+		return true;
+	}
+
+	return false;
+}
+
+// пропуск обязательного символа c
+void Expression::Expect(char c) {
+	if (!Accept(c))
+		Error(std::string("expected '") + c + "'");
+}
+
+// операнд-константа
+ExpressionOperand Expression::Constant(double value) const {
+	return { true, value, 0 };
+}
+
+// операнд-регистр
+ExpressionOperand Expression::Register(size_t reg) const {
+	return { false, 0, reg };
+}
+
+// освобождение временного регистра (регистры переменных не освобождаются)
+void Expression::Release(const ExpressionOperand &operand) {
+	if (!operand.constant && operand.reg > dimensions)
+		freeRegisters.push_back(operand.reg);
+}
+
+// добавление инструкции со свёрткой констант
+ExpressionOperand Expression::Emit(ExpressionCode code, const ExpressionOperand &a, const ExpressionOperand &b) {
+	bool unary = code >= ExpressionCode::Neg;
+
+	if (a.constant && (unary || b.constant))
+		return Constant(Apply(code, a.value, b.value)); // подвыражение из констант вычисляется при компиляции
+
+	// операции с нейтральным элементом не порождают инструкций
+	if (!unary && b.constant && ((b.value == 0 && (code == ExpressionCode::Add || code == ExpressionCode::Sub)) || (b.value == 1 && (code == ExpressionCode::Mul || code == ExpressionCode::Div || code == ExpressionCode::Pow))))
+		return a;
+
+	if (code == ExpressionCode::Add && a.constant && a.value == 0)
+		return b;
+
+	if (code == ExpressionCode::Mul && a.constant && a.value == 1)
+		return b;
+
+	// квадрат вычисляется умножением, а не pow
+	if (code == ExpressionCode::Pow && b.constant && b.value == 2)
+		return Emit(ExpressionCode::Mul, a, a);
+
+	// операнды освобождаются до выбора регистра результата: операции поэлементные, поэтому результат может занять регистр операнда
+	Release(a);
+
+	if (!unary && !(b.constant || (!a.constant && a.reg == b.reg)))
+		Release(b);
+
+	size_t dst;
+
+	if (freeRegisters.empty()) {
+		dst = registers++;
+	}
+	else {
+		dst = freeRegisters.back();
+		freeRegisters.pop_back();
+	}
+
+	program.push_back({ code, dst, a, unary ? Constant(0) : b });
+	return Register(dst);
+}
+
+// сумма и разность
+ExpressionOperand Expression::ParseSum() {
+	ExpressionOperand left = ParseProduct();
+
+	while (true) {
+		if (Accept('+')) {
+			ExpressionOperand right = ParseProduct();
+			left = Emit(ExpressionCode::Add, left, right);
+		}
+		else if (Accept('-')) {
+			ExpressionOperand right = ParseProduct();
+			left = Emit(ExpressionCode::Sub, left, right);
+		}
+		else {
+			return left;
+		}
+	}
+}
+
+// произведение и частное
+ExpressionOperand Expression::ParseProduct() {
+	ExpressionOperand left = ParseUnary();
+
+	while (true) {
+		if (Accept('*')) {
+			ExpressionOperand right = ParseUnary();
+			left = Emit(ExpressionCode::Mul, left, right);
+		}
+		else if (Accept('/')) {
+			ExpressionOperand right = ParseUnary();
+			left = Emit(ExpressionCode::Div, left, right);
+		}
+		else {
+			return left;
+		}
+	}
+}
+
+// унарные плюс и минус
+ExpressionOperand Expression::ParseUnary() {
+	if (Accept('-'))
+		return Emit(ExpressionCode::Neg, ParseUnary(), Constant(0));
+
+	if (Accept('+'))
+		return ParseUnary();
+
+	return ParsePower();
+}
+
+// возведение в степень (правоассоциативное, -x^2 = -(x^2))
+ExpressionOperand Expression::ParsePower() {
+	ExpressionOperand base = ParsePrimary();
+
+	if (!Accept('^'))
+		return base;
+
+	ExpressionOperand exponent = ParseUnary();
+	return Emit(ExpressionCode::Pow, base, exponent);
+}
+
+// число, переменная, вызов функции или выражение в скобках
+ExpressionOperand Expression::ParsePrimary() {
+	if (Accept('(')) {
+		ExpressionOperand operand = ParseSum();
+		Expect(')');
+		return operand;
+	}
+
+	if (position < text.length() && (isdigit(text[position]) || text[position] == '.')) {
+		const char *start = text.c_str() + position;
+		char *end;
+		double value = strtod(start, &end);
+
+		if (end == start)
+			Error("invalid number");
+
+		position += end - start;
+		return Constant(value);
+	}
+
+	size_t start = position;
+
+	while (position < text.length() && (isalnum(text[position]) || text[position] == '_'))
+		position++;
+
+	std::string name = text.substr(start, position - start);
+
+	if (name == "") {
+		position = start;
+		Error(position < text.length() ? "unexpected symbol '" + text.substr(position, 1) + "'" : "unexpected end");
+	}
+
+	if (Accept('('))
+		return ParseCall(name);
+
+	if (name == "pi")
+		return Constant(acos(-1.0));
+
+	if (name == "e")
+		return Constant(exp(1.0));
+
+	if (name == "x") {
+		summed = true;
+		return Register(0);
+	}
+
+	if (name[0] == 'x' && name.find_first_not_of("0123456789", 1) == std::string::npos) {
+		size_t index = std::stoul(name.substr(1));
+
+		if (index < 1 || index > dimensions)
+			Error("variable '" + name + "' is out of dimensions");
+
+		return Register(index);
+	}
+
+	position = start;
+	Error("unknown variable '" + name + "'");
+	return Constant(0);
+}
+
+// вызов функции
+ExpressionOperand Expression::ParseCall(const std::string &name) {
+	const std::string unaryNames[] = { "sin", "cos", "tan", "asin", "acos", "atan", "exp", "log", "sqrt", "abs", "floor" };
+	const ExpressionCode unaryCodes[] = { ExpressionCode::Sin, ExpressionCode::Cos, ExpressionCode::Tan, ExpressionCode::Asin, ExpressionCode::Acos, ExpressionCode::Atan, ExpressionCode::Exp, ExpressionCode::Log, ExpressionCode::Sqrt, ExpressionCode::Abs, ExpressionCode::Floor };
+
+	for (size_t i = 0; i < 11; i++) {
+		if (name == unaryNames[i]) {
+			ExpressionOperand argument = ParseSum();
+			Expect(')');
+			return Emit(unaryCodes[i], argument, Constant(0));
+		}
+	}
+
+	ExpressionCode code = ExpressionCode::Pow;
+
+	if (name == "min")
+		code = ExpressionCode::Min;
+	else if (name == "max")
+		code = ExpressionCode::Max;
+	else if (name != "pow")
+		Error("unknown function '" + name + "'");
+
+	ExpressionOperand a = ParseSum();
+	Expect(',');
+	ExpressionOperand b = ParseSum();
+	Expect(')');
+	return Emit(code, a, b);
+}
+
+// значение операции (для свёртки констант, должно совпадать с выполнением программы)
+double Expression::Apply(ExpressionCode code, double a, double b) {
+	switch (code) {
+		case ExpressionCode::Add: return a + b;
+		case ExpressionCode::Sub: return a - b;
+		case ExpressionCode::Mul: return a * b;
+		case ExpressionCode::Div: return a / b;
+		case ExpressionCode::Pow: return pow(a, b);
+		case ExpressionCode::Min: return std::min(a, b);
+		case ExpressionCode::Max: return std::max(a, b);
+		case ExpressionCode::Neg: return -a;
+		case ExpressionCode::Sin: return sin(a);
+		case ExpressionCode::Cos: return cos(a);
+		case ExpressionCode::Tan: return tan(a);
+		case ExpressionCode::Asin: return asin(a);
+		case ExpressionCode::Acos: return acos(a);
+		case ExpressionCode::Atan: return atan(a);
+		case ExpressionCode::Exp: return exp(a);
+		case ExpressionCode::Log: return log(a);
+		case ExpressionCode::Sqrt: return sqrt(a);
+		case ExpressionCode::Abs: return fabs(a);
+		case ExpressionCode::Floor: return floor(a);
+	}
+
+	return 0;
+}
+
+// выполнение программы над блоком из n точек: values[r] - значения регистра r для всех точек блока
+void Expression::Run(double **values, size_t n) const {
+	for (size_t i = 0; i < program.size(); i++) {
+		const ExpressionInstruction &instruction = program[i];
+		double *dst = values[instruction.dst];
+		const double *a = instruction.a.constant ? nullptr : values[instruction.a.reg];
+		const double *b = instruction.b.constant ? nullptr : values[instruction.b.reg];
+		double av = instruction.a.value;
+		double bv = instruction.b.value;
+
+		// одна проверка кода на инструкцию и блок, внутренние циклы без ветвлений
+		switch (instruction.code) {
+			case ExpressionCode::Add: ExpressionBinary(dst, a, av, b, bv, n, [](double u, double v) { return u + v; }); break;
+			case ExpressionCode::Sub: ExpressionBinary(dst, a, av, b, bv, n, [](double u, double v) { return u - v; }); break;
+			case ExpressionCode::Mul: ExpressionBinary(dst, a, av, b, bv, n, [](double u, double v) { return u * v; }); break;
+			case ExpressionCode::Div: ExpressionBinary(dst, a, av, b, bv, n, [](double u, double v) { return u / v; }); break;
+			case ExpressionCode::Pow: ExpressionBinary(dst, a, av, b, bv, n, [](double u, double v) { return pow(u, v); }); break;
+			case ExpressionCode::Min: ExpressionBinary(dst, a, av, b, bv, n, [](double u, double v) { return std::min(u, v); }); break;
+			case ExpressionCode::Max: ExpressionBinary(dst, a, av, b, bv, n, [](double u, double v) { return std::max(u, v); }); break;
+			case ExpressionCode::Neg: ExpressionUnary(dst, a, n, [](double u) { return -u; }); break;
+			case ExpressionCode::Sin: ExpressionUnary(dst, a, n, [](double u) { return sin(u); }); break;
+			case ExpressionCode::Cos: ExpressionUnary(dst, a, n, [](double u) { return cos(u); }); break;
+			case ExpressionCode::Tan: ExpressionUnary(dst, a, n, [](double u) { return tan(u); }); break;
+			case ExpressionCode::Asin: ExpressionUnary(dst, a, n, [](double u) { return asin(u); }); break;
+			case ExpressionCode::Acos: ExpressionUnary(dst, a, n, [](double u) { return acos(u); }); break;
+			case ExpressionCode::Atan: ExpressionUnary(dst, a, n, [](double u) { return atan(u); }); break;
+			case ExpressionCode::Exp: ExpressionUnary(dst, a, n, [](double u) { return exp(u); }); break;
+			case ExpressionCode::Log: ExpressionUnary(dst, a, n, [](double u) { return log(u); }); break;
+			case ExpressionCode::Sqrt: ExpressionUnary(dst, a, n, [](double u) { return sqrt(u); }); break;
+			case ExpressionCode::Abs: ExpressionUnary(dst, a, n, [](double u) { return fabs(u); }); break;
+			case ExpressionCode::Floor: ExpressionUnary(dst, a, n, [](double u) { return floor(u); }); break;
+		}
+	}
+}
+
+// получение числа инструкций
+size_t Expression::GetInstructions() const {
+	return program.size();
+}
+
+// получение числа регистров
+size_t Expression::GetRegisters() const {
+	return registers;
+}
+
+// получение числа целей
+size_t Expression::GetOutputs() const {
+	return results.size();
+}
+
+// оценка n точек по dimensions координат подряд
+void Expression::Evaluate(const double *x, double *scores, size_t n) const {
+	size_t block = std::min(n, BLOCK);
+
+	// рабочая память своя у каждого потока и только растёт, поэтому оценка по одной точке (F в main.cpp) не выделяет память на каждом вызове
+	static thread_local std::vector<double> memory; // регистры хранятся по столбцам: значения одного регистра для всех точек блока подряд
+	static thread_local std::vector<double*> values;
+
+	if (memory.size() < registers * block)
+		memory.resize(registers * block);
+
+	if (values.size() < registers)
+		values.resize(registers);
+
+	for (size_t r = 0; r < registers; r++)
+		values[r] = memory.data() + r * block;
+
+	for (size_t start = 0; start < n; start += block) {
+		size_t count = std::min(block, n - start);
+
+		// точки блока переставляются из строк в столбцы регистров x1, ..., xN
+		for (size_t i = 0; i < count; i++)
+			for (size_t j = 0; j < dimensions; j++)
+				values[j + 1][i] = x[(start + i) * dimensions + j];
+
+		size_t outputs = results.size();
+		double *total = scores + start * outputs;
+		size_t passes = summed ? dimensions : 1;
+
+		for (size_t i = 0; i < count * outputs; i++)
+			total[i] = 0;
+
+		for (size_t pass = 0; pass < passes; pass++) {
+			values[0] = values[pass + 1]; // x - текущая координата
+
+			Run(values.data(), count);
+
+			for (size_t k = 0; k < outputs; k++) {
+				const ExpressionOperand &result = results[k];
+
+				for (size_t i = 0; i < count; i++)
+					total[i * outputs + k] += result.constant ? result.value : values[result.reg][i];
+			}
+		}
+	}
+}
+
+// вывод программы
+std::ostream& operator<<(std::ostream& os, const Expression &expression) {
+	const char *names[] = { "add", "sub", "mul", "div", "pow", "min", "max", "neg", "sin", "cos", "tan", "asin", "acos", "atan", "exp", "log", "sqrt", "abs", "floor" };
+
+	for (size_t i = 0; i < expression.program.size(); i++) {
+		const ExpressionInstruction &instruction = expression.program[i];
+		os << "r" << instruction.dst << " = " << names[(int) instruction.code] << " ";
+
+		if (instruction.a.constant)
+			os << instruction.a.value;
+		else
+			os << "r" << instruction.a.reg;
+
+		if (instruction.code < ExpressionCode::Neg) {
+			if (instruction.b.constant)
+				os << ", " << instruction.b.value;
+			else
+				os << ", r" << instruction.b.reg;
+		}
+
+		os << std::endl;
+	}
+
+	for (size_t i = 0; i < expression.results.size(); i++) {
+		os << "out" << i << " = ";
+
+		if (expression.results[i].constant)
+			os << expression.results[i].value;
+		else
+			os << "r" << expression.results[i].reg;
+
+		os << std::endl;
+	}
+
+	return os;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include "Checkpoint.hpp"
+
+// ограниченный кэш значений оценочной функции (открытая адресация с линейным пробированием)
+template <typename Gene>
+class FitnessCache {
+	size_t dimensions; // число генов в ключе
+	std::vector<Gene> keys; // гены особей, по dimensions на ячейку
+	std::vector<double> values; // значения оценочной функции
+	std::vector<bool> used; // заняты ли ячейки
+	size_t limit; // максимальное число хранимых значений
+	size_t size; // текущее число хранимых значений
+	int shift; // сдвиг для получения индекса из хэша
+
+	size_t GetIndex(const Gene *genes) const; // получение начальной ячейки для генов
+	bool IsEqual(size_t index, const Gene *genes) const; // совпадают ли гены ячейки с заданными
+public:
+	FitnessCache(size_t limit, size_t dimensions); // создание кэша на заданное число значений (0 - кэш отключён)
+
+	bool IsEnabled() const; // используется ли кэш
+	bool Find(const Gene *genes, double &value) const; // поиск значения по генам
+	void Insert(const Gene *genes, double value); // добавление значения
+	void Clear(); // очистка кэша
+	size_t GetSize() const; // получение числа хранимых значений
+
+	void Save(BinaryWriter &writer) const; // запись содержимого кэша в снимок
+	void Load(BinaryReader &reader); // восстановление содержимого кэша из снимка
+};
+
+// создание кэша на заданное число значений (0 - кэш отключён)
+template <typename Gene>
+FitnessCache<Gene>::FitnessCache(size_t limit, size_t dimensions) {
+	this->dimensions = dimensions;
+	this->limit = limit;
+	this->size = 0;
+	this->shift = 64;
+
+	if (limit == 0)
+		return;
+
+	size_t capacity = 2;
+
+	// заполненность таблицы не превышает половины, чтобы цепочки пробирования были короткими
+	while (capacity < 2 * limit) {
+		capacity *= 2;
+		shift--;
+	}
+
+	shift--;
+	keys.resize(capacity * dimensions);
+	values.assign(capacity, 0);
+	used.assign(capacity, false);
+}
+
+// получение начальной ячейки для генов (мультипликативное хэширование по старшим битам)
+template <typename Gene>
+size_t FitnessCache<Gene>::GetIndex(const Gene *genes) const {
+	uint64_t hash = 0;
+
+	for (size_t i = 0; i < dimensions; i++)
+		hash = (hash ^ (hash >> 29)) * 0xBF58476D1CE4E5B9ULL + genes[i].GetHash();
+
+	return (hash * 0x9E3779B97F4A7C15ULL) >> shift;
+}
+
+// совпадают ли гены ячейки с заданными
+template <typename Gene>
+bool FitnessCache<Gene>::IsEqual(size_t index, const Gene *genes) const {
+	for (size_t i = 0; i < dimensions; i++)
+		if (!(keys[index * dimensions + i] == genes[i]))
+			return false;
+
+	return true;
+}
+
+// используется ли кэш
+template <typename Gene>
+bool FitnessCache<Gene>::IsEnabled() const {
+	return limit > 0;
+}
+
+// поиск значения по генам
+template <typename Gene>
+bool FitnessCache<Gene>::Find(const Gene *genes, double &value) const {
+	if (!IsEnabled())
+		return false;
+
+	size_t mask = used.size() - 1;
+
+	for (size_t i = GetIndex(genes); used[i]; i = (i + 1) & mask) {
+		if (IsEqual(i, genes)) {
+			value = values[i];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// добавление значения
+template <typename Gene>
+void FitnessCache<Gene>::Insert(const Gene *genes, double value) {
+	if (!IsEnabled())
+		return;
+
+	// при переполнении начинаем заполнять кэш заново
+	if (size == limit)
+		Clear();
+
+	size_t mask = used.size() - 1;
+	size_t i = GetIndex(genes);
+
+	while (used[i] && !IsEqual(i, genes))
+		i = (i + 1) & mask;
+
+	if (!used[i])
+		size++;
+
+	for (size_t j = 0; j < dimensions; j++)
+		keys[i * dimensions + j] = genes[j];
+
+	values[i] = value;
+	used[i] = true;
+}
+
+// очистка кэша
+template <typename Gene>
+void FitnessCache<Gene>::Clear() {
+	for (size_t i = 0; i < used.size(); i++)
+		used[i] = false;
+
+	size = 0;
+}
+
+// получение числа хранимых значений
+template <typename Gene>
+size_t FitnessCache<Gene>::GetSize() const {
+	return size;
+}
+
+// запись содержимого кэша в снимок: таблица сохраняется целиком вместе с положением ячеек,
+// поэтому после восстановления попадания и очистка при переполнении происходят так же, как без прерывания
+template <typename Gene>
+void FitnessCache<Gene>::Save(BinaryWriter &writer) const {
+	writer.Write((uint64_t) used.size());
+	writer.Write((uint64_t) size);
+	writer.WriteBytes(keys.data(), keys.size() * sizeof(Gene));
+	writer.WriteBytes(values.data(), values.size() * sizeof(double));
+
+	for (size_t i = 0; i < used.size(); i++)
+		writer.Write((uint8_t) used[i]);
+}
+
+// восстановление содержимого кэша из снимка
+template <typename Gene>
+void FitnessCache<Gene>::Load(BinaryReader &reader) {
+	uint64_t capacity;
+	uint64_t count;
+	uint8_t flag;
+
+	reader.Read(capacity);
+	reader.Read(count);
+
+	if (capacity != used.size() || count > limit)
+		throw std::runtime_error("checkpoint cache does not match the configuration");
+
+	reader.ReadBytes(keys.data(), keys.size() * sizeof(Gene));
+	reader.ReadBytes(values.data(), values.size() * sizeof(double));
+
+	for (size_t i = 0; i < used.size(); i++) {
+		reader.Read(flag);
+		used[i] = flag != 0;
+	}
+
+	size = count;
+}
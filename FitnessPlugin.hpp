@@ -0,0 +1,81 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <dlfcn.h>
+
+#include "GeneticPlugin.h"
+
+// оценочная функция из разделяемой библиотеки с интерфейсом GeneticPlugin.h
+// библиотека загружается один раз, а каждый вызов оценивает сразу весь пакет точек, поэтому цена косвенного вызова не заметна
+class FitnessPlugin {
+	void *library; // дескриптор загруженной библиотеки
+	void *context; // контекст, созданный библиотекой
+	GeneticPluginEvaluate evaluate; // пакетная оценка
+	GeneticPluginRelease release; // освобождение контекста (может отсутствовать)
+
+	void* GetSymbol(const std::string &path, const char *name, bool required); // получение адреса экспортируемой функции
+public:
+	FitnessPlugin(const std::string &path, const std::string &args, size_t dimensions); // загрузка библиотеки и создание контекста
+	~FitnessPlugin();
+
+	FitnessPlugin(const FitnessPlugin&) = delete;
+	FitnessPlugin& operator=(const FitnessPlugin&) = delete;
+
+	void Evaluate(const double *x, double *scores, size_t n) const; // оценка n точек подряд
+};
+
+// получение адреса экспортируемой функции
+void* FitnessPlugin::GetSymbol(const std::string &path, const char *name, bool required) {
+	dlerror(); // сбрасываем предыдущую ошибку
+	void *symbol = dlsym(library, name);
+
+	if (!symbol && required) {
+		dlclose(library);
+		throw std::runtime_error("plugin '" + path + "' does not export " + name);
+	}
+
+	return symbol;
+}
+
+// загрузка библиотеки и создание контекста
+FitnessPlugin::FitnessPlugin(const std::string &path, const std::string &args, size_t dimensions) {
+	// без каталога в имени dlopen ищет библиотеку в системных путях, поэтому относительный путь дополняется до явного
+	std::string name = path.find('/') == std::string::npos ? "./" + path : path;
+	library = dlopen(name.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+	if (!library)
+		throw std::runtime_error("unable to load plugin '" + path + "': " + dlerror());
+
+	GeneticPluginVersion version = (GeneticPluginVersion) GetSymbol(path, "genetic_plugin_version", true);
+	GeneticPluginInit init = (GeneticPluginInit) GetSymbol(path, "genetic_plugin_init", true);
+	evaluate = (GeneticPluginEvaluate) GetSymbol(path, "genetic_plugin_evaluate", true);
+	release = (GeneticPluginRelease) GetSymbol(path, "genetic_plugin_release", false);
+
+	unsigned abi = version(); // версия читается до выгрузки библиотеки, после dlclose её функции вызывать нельзя
+
+	if (abi != GENETIC_PLUGIN_ABI_VERSION) {
+		dlclose(library);
+		throw std::runtime_error("plugin '" + path + "' has ABI version " + std::to_string(abi) + ", expected " + std::to_string(GENETIC_PLUGIN_ABI_VERSION));
+	}
+
+	context = nullptr;
+
+	if (init(dimensions, args.c_str(), &context) != 0) {
+		dlclose(library);
+		throw std::runtime_error("plugin '" + path + "' failed to initialize with args '" + args + "'");
+	}
+}
+
+FitnessPlugin::~FitnessPlugin() {
+	if (release)
+		release(context);
+
+	dlclose(library);
+}
+
+// оценка n точек подряд
+void FitnessPlugin::Evaluate(const double *x, double *scores, size_t n) const {
+	evaluate(x, scores, n, context);
+}
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <cmath>
+#include <algorithm>
+
+#include "Config.hpp"
+#include "Population.hpp"
+#include "Checkpoint.hpp"
+#include "Operators.hpp"
+
+// причина остановки алгоритма
+enum class StopReason {
+	None, // алгоритм не остановлен
+	MaxEpochs, // выполнено максимальное число эпох
+	Valueless, // превышено число эпох без улучшения
+	Stopped // остановлен вызовом Stop
+};
+
+// генетический алгоритм: цикл эпох с критериями остановки и обработчиками эпох
+// Fitness - функция, функтор или лямбда от точки (const double *x, size_t dimensions) либо пакетная функция BatchFunction,
+// Operators - набор операторов популяции (см. Operators.hpp)
+template <unsigned Bits, typename Fitness, typename Operators = RuntimeOperators>
+class GeneticAlgorithm {
+public:
+	typedef std::function<void(GeneticAlgorithm&)> Callback; // обработчик эпохи
+
+private:
+	Config config; // конфигурация
+	Config boostedConfig; // конфигурация с повышенной вероятностью мутации (при потере разнообразия)
+	Fitness fitness; // оценочная функция
+	Population<Bits, Operators> population; // популяция
+
+	size_t epoch; // номер текущей эпохи
+	size_t nochangingIterations; // число эпох без улучшения
+	double prevBest; // лучшее значение предыдущей эпохи
+	Entity<Bits> epochBest; // лучшая особь текущей эпохи
+	Entity<Bits> best; // лучшая особь за всё время
+	Entity<Bits> refined; // лучшая особь после локального поиска
+	bool hasBest; // найдена ли хотя бы одна особь
+	StopReason reason; // причина остановки
+	bool diversityUpdated; // рассчитано ли разнообразие текущих генов
+	bool collapsed; // потеряно ли разнообразие на текущей эпохе
+	size_t collapses; // число эпох с потерей разнообразия
+
+	std::vector<Callback> evaluatedCallbacks; // обработчики оценённой популяции
+	std::vector<Callback> epochEndCallbacks; // обработчики конца эпохи
+
+	void Notify(std::vector<Callback> &callbacks); // вызов обработчиков
+public:
+	GeneticAlgorithm(const Config &config, Fitness fitness, size_t stream = 0); // создание алгоритма с новой популяцией
+
+	void OnEvaluated(const Callback &callback); // добавление обработчика, вызываемого после оценки популяции и проверки критериев остановки
+	void OnEpochEnd(const Callback &callback); // добавление обработчика, вызываемого после построения следующего поколения
+
+	bool Step(); // выполнение одной эпохи, false после остановки
+	const Entity<Bits>& Run(); // выполнение эпох до остановки, возвращает лучшую особь
+	void Stop(); // остановка алгоритма после текущей фазы
+
+	void SaveCheckpoint(const std::string &path) const; // сохранение снимка перед следующей эпохой
+	void LoadCheckpoint(const Checkpoint &checkpoint); // продолжение работы из снимка
+
+	const Config& GetConfig() const; // получение конфигурации
+	size_t GetEpoch() const; // получение номера текущей эпохи
+	size_t GetNochangingIterations() const; // получение числа эпох без улучшения
+	bool IsFinished() const; // остановлен ли алгоритм
+	StopReason GetStopReason() const; // получение причины остановки
+	const Entity<Bits>& GetEpochBest() const; // получение лучшей особи текущей эпохи
+	const Entity<Bits>& GetBestEntity() const; // получение лучшей особи за всё время
+	const Diversity<Bits>& GetDiversity(); // получение разнообразия текущих генов (рассчитывается не более раза на поколение)
+	bool IsCollapsed() const; // потеряно ли разнообразие на текущей эпохе
+	size_t GetCollapses() const; // получение числа эпох с потерей разнообразия
+	Population<Bits, Operators>& GetPopulation(); // получение популяции
+	const Population<Bits, Operators>& GetPopulation() const; // получение популяции
+};
+
+// создание алгоритма с выводом типа оценочной функции
+template <unsigned Bits, typename Operators = RuntimeOperators, typename Fitness>
+GeneticAlgorithm<Bits, Fitness, Operators> MakeGeneticAlgorithm(const Config &config, Fitness fitness, size_t stream = 0) {
+	return GeneticAlgorithm<Bits, Fitness, Operators>(config, fitness, stream);
+}
+
+// создание алгоритма с новой популяцией
+template <unsigned Bits, typename Fitness, typename Operators>
+GeneticAlgorithm<Bits, Fitness, Operators>::GeneticAlgorithm(const Config &config, Fitness fitness, size_t stream) : config(config), boostedConfig(config), fitness(fitness), population(config, stream) {
+	epoch = 0;
+	nochangingIterations = 0;
+	prevBest = 0;
+	hasBest = false;
+	reason = StopReason::None;
+	diversityUpdated = false;
+	collapsed = false;
+	collapses = 0;
+
+	boostedConfig.mutationProbability = std::min(1.0, config.mutationProbability * config.diversityBoost);
+}
+
+// вызов обработчиков
+template <unsigned Bits, typename Fitness, typename Operators>
+void GeneticAlgorithm<Bits, Fitness, Operators>::Notify(std::vector<Callback> &callbacks) {
+	for (size_t i = 0; i < callbacks.size(); i++)
+		callbacks[i](*this);
+}
+
+// добавление обработчика, вызываемого после оценки популяции и проверки критериев остановки
+template <unsigned Bits, typename Fitness, typename Operators>
+void GeneticAlgorithm<Bits, Fitness, Operators>::OnEvaluated(const Callback &callback) {
+	evaluatedCallbacks.push_back(callback);
+}
+
+// добавление обработчика, вызываемого после построения следующего поколения
+template <unsigned Bits, typename Fitness, typename Operators>
+void GeneticAlgorithm<Bits, Fitness, Operators>::OnEpochEnd(const Callback &callback) {
+	epochEndCallbacks.push_back(callback);
+}
+
+// выполнение одной эпохи, false после остановки
+template <unsigned Bits, typename Fitness, typename Operators>
+bool GeneticAlgorithm<Bits, Fitness, Operators>::Step() {
+	if (reason == StopReason::None && epoch >= config.maxEpochs)
+		reason = StopReason::MaxEpochs;
+
+	if (reason != StopReason::None)
+		return false;
+
+	population.ResetStatistics();
+	population.Eval(config, fitness); // оцениваем популяцию
+	diversityUpdated = false;
+	collapsed = config.diversityPolicy != DiversityPolicy::None && GetDiversity().GetDiversity() < config.diversityThreshold;
+
+	if (collapsed)
+		collapses++;
+
+	population.GetBestEntity(config, epochBest); // получаем лучшую особь в уже выделенную память
+
+	double currBest = epochBest.GetScore();
+
+	if (!hasBest || (currBest - best.GetScore()) * Operators::GetScale(config) > 0) {
+		best = epochBest;
+		hasBest = true;
+	}
+
+	// если не нулевая эпоха и значение изменилось недостаточно сильно
+	if (epoch > 0 && fabs(prevBest - currBest) < config.qualityEpsilon) {
+		nochangingIterations++; // увеличиваем счётчик эпох без изменений
+
+		if (nochangingIterations >= config.maxValuelessEpochs)
+			reason = StopReason::Valueless; // превышен лимит без изменений
+	}
+	else {
+		nochangingIterations = 0;
+	}
+
+	Notify(evaluatedCallbacks);
+
+	if (reason != StopReason::None)
+		return false;
+
+	prevBest = currBest; // обновляем предыдущее лучшее значение
+
+	population.Selection(config); // запускаем селекцию
+
+	// локальный поиск улучшает защищённых особей до скрещивания, поэтому улучшения сразу передаются потомкам
+	if (config.memeticElites > 0) {
+		population.Refine(config, fitness);
+		population.GetBestEntity(config, refined);
+
+		if ((refined.GetScore() - best.GetScore()) * Operators::GetScale(config) > 0)
+			best = refined;
+	}
+
+	population.Crossbreeding(config); // запускаем скрещивание
+	population.Mutation(collapsed && config.diversityPolicy == DiversityPolicy::Mutation ? boostedConfig : config); // запускаем мутацию
+
+	// популяция сошлась к одному геному: вместо продолжения мёртвого поиска незащищённые особи заменяются случайными
+	if (collapsed && config.diversityPolicy == DiversityPolicy::Restart)
+		population.Reseed(config);
+
+	diversityUpdated = false;
+	epoch++;
+
+	Notify(epochEndCallbacks);
+
+	if (reason == StopReason::None && epoch >= config.maxEpochs)
+		reason = StopReason::MaxEpochs;
+
+	return reason == StopReason::None;
+}
+
+// выполнение эпох до остановки, возвращает лучшую особь
+template <unsigned Bits, typename Fitness, typename Operators>
+const Entity<Bits>& GeneticAlgorithm<Bits, Fitness, Operators>::Run() {
+	while (Step())
+		;
+
+	return best;
+}
+
+// остановка алгоритма после текущей фазы
+template <unsigned Bits, typename Fitness, typename Operators>
+void GeneticAlgorithm<Bits, Fitness, Operators>::Stop() {
+	if (reason == StopReason::None)
+		reason = StopReason::Stopped;
+}
+
+// сохранение снимка перед следующей эпохой
+template <unsigned Bits, typename Fitness, typename Operators>
+void GeneticAlgorithm<Bits, Fitness, Operators>::SaveCheckpoint(const std::string &path) const {
+	population.SaveCheckpoint(path, config, { epoch, nochangingIterations, prevBest });
+}
+
+// продолжение работы из снимка с сохранённой эпохи
+template <unsigned Bits, typename Fitness, typename Operators>
+void GeneticAlgorithm<Bits, Fitness, Operators>::LoadCheckpoint(const Checkpoint &checkpoint) {
+	CheckpointState state = checkpoint.GetState();
+
+	population.LoadCheckpoint(config, checkpoint);
+	epoch = state.epoch;
+	nochangingIterations = state.nochangingIterations;
+	prevBest = state.prevBest;
+	hasBest = false;
+	reason = StopReason::None;
+	diversityUpdated = false;
+}
+
+// получение конфигурации
+template <unsigned Bits, typename Fitness, typename Operators>
+const Config& GeneticAlgorithm<Bits, Fitness, Operators>::GetConfig() const {
+	return config;
+}
+
+// получение номера текущей эпохи
+template <unsigned Bits, typename Fitness, typename Operators>
+size_t GeneticAlgorithm<Bits, Fitness, Operators>::GetEpoch() const {
+	return epoch;
+}
+
+// получение числа эпох без улучшения
+template <unsigned Bits, typename Fitness, typename Operators>
+size_t GeneticAlgorithm<Bits, Fitness, Operators>::GetNochangingIterations() const {
+	return nochangingIterations;
+}
+
+// остановлен ли алгоритм
+template <unsigned Bits, typename Fitness, typename Operators>
+bool GeneticAlgorithm<Bits, Fitness, Operators>::IsFinished() const {
+	return reason != StopReason::None;
+}
+
+// получение причины остановки
+template <unsigned Bits, typename Fitness, typename Operators>
+StopReason GeneticAlgorithm<Bits, Fitness, Operators>::GetStopReason() const {
+	return reason;
+}
+
+// получение лучшей особи текущей эпохи
+template <unsigned Bits, typename Fitness, typename Operators>
+const Entity<Bits>& GeneticAlgorithm<Bits, Fitness, Operators>::GetEpochBest() const {
+	return epochBest;
+}
+
+// получение лучшей особи за всё время
+template <unsigned Bits, typename Fitness, typename Operators>
+const Entity<Bits>& GeneticAlgorithm<Bits, Fitness, Operators>::GetBestEntity() const {
+	return best;
+}
+
+// получение разнообразия текущих генов (рассчитывается не более раза на поколение)
+template <unsigned Bits, typename Fitness, typename Operators>
+const Diversity<Bits>& GeneticAlgorithm<Bits, Fitness, Operators>::GetDiversity() {
+	if (!diversityUpdated) {
+		population.UpdateDiversity(config);
+		diversityUpdated = true;
+	}
+
+	return population.GetDiversity();
+}
+
+// потеряно ли разнообразие на текущей эпохе
+template <unsigned Bits, typename Fitness, typename Operators>
+bool GeneticAlgorithm<Bits, Fitness, Operators>::IsCollapsed() const {
+	return collapsed;
+}
+
+// получение числа эпох с потерей разнообразия
+template <unsigned Bits, typename Fitness, typename Operators>
+size_t GeneticAlgorithm<Bits, Fitness, Operators>::GetCollapses() const {
+	return collapses;
+}
+
+// получение популяции
+template <unsigned Bits, typename Fitness, typename Operators>
+Population<Bits, Operators>& GeneticAlgorithm<Bits, Fitness, Operators>::GetPopulation() {
+	return population;
+}
+
+// получение популяции
+template <unsigned Bits, typename Fitness, typename Operators>
+const Population<Bits, Operators>& GeneticAlgorithm<Bits, Fitness, Operators>::GetPopulation() const {
+	return population;
+}
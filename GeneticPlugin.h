@@ -0,0 +1,38 @@
+#ifndef GENETIC_PLUGIN_H
+#define GENETIC_PLUGIN_H
+
+#include <stddef.h>
+
+// двоичный интерфейс подключаемой оценочной функции: библиотека экспортирует функции с этими именами без декорирования (extern "C")
+// интерфейс меняется только вместе с номером версии, поэтому библиотеки собираются независимо от программы
+
+#define GENETIC_PLUGIN_ABI_VERSION 1 // версия интерфейса
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// версия интерфейса, с которой собрана библиотека (обязательна)
+typedef unsigned (*GeneticPluginVersion)(void);
+
+// создание контекста для пространства поиска из dimensions измерений, args - строка plugin_args из конфигурации (обязательна)
+// возвращает 0 при успехе, контекст записывается в *ctx и передаётся во все остальные вызовы
+typedef int (*GeneticPluginInit)(size_t dimensions, const char *args, void **ctx);
+
+// пакетная оценка n точек по dimensions координат подряд в out[0..n-1] (обязательна)
+// может вызываться одновременно из нескольких потоков для разных точек, поэтому контекст не должен изменяться
+typedef void (*GeneticPluginEvaluate)(const double *xs, double *out, size_t n, void *ctx);
+
+// освобождение контекста (необязательна)
+typedef void (*GeneticPluginRelease)(void *ctx);
+
+unsigned genetic_plugin_version(void);
+int genetic_plugin_init(size_t dimensions, const char *args, void **ctx);
+void genetic_plugin_evaluate(const double *xs, double *out, size_t n, void *ctx);
+void genetic_plugin_release(void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
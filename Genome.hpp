@@ -0,0 +1,224 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <type_traits>
+#include "Random.hpp"
+
+// разворот порядка 64 бит
+uint64_t ReverseBits(uint64_t bits) {
+#if defined(__clang__)
+	return __builtin_bitreverse64(bits);
+#else
+	bits = ((bits >> 1) & 0x5555555555555555ULL) | ((bits & 0x5555555555555555ULL) << 1);
+	bits = ((bits >> 2) & 0x3333333333333333ULL) | ((bits & 0x3333333333333333ULL) << 2);
+	bits = ((bits >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((bits & 0x0F0F0F0F0F0F0F0FULL) << 4);
+	return __builtin_bswap64(bits);
+#endif
+}
+
+// геном из Bits бит: одно машинное слово до 64 бит включительно, упакованный массив слов для больших размеров
+template <unsigned Bits>
+struct Genome {
+	static const unsigned Words = (Bits + 63) / 64; // число 64-битных слов
+	static const unsigned TopBits = Bits - 64 * (Words - 1); // число используемых бит старшего слова
+	static const uint64_t TopMask = ~0ULL >> (64 - TopBits); // маска используемых бит старшего слова
+
+	// тип для декодирования: double точно хранит до 53 бит, более длинные геномы декодируются в расширенной точности
+	typedef typename std::conditional<(Bits > 53), long double, double>::type Value;
+
+	uint64_t words[Words]; // слова генома, начиная с младшего
+
+	static Genome GetZero(); // получение нулевого генома
+	static Genome GetRandom(Random &random); // получение случайного генома
+	static Genome GetLowMask(unsigned count); // получение маски младших count бит
+
+	bool GetBit(unsigned index) const; // получение бита по индексу
+	void SetBit(unsigned index, bool bit); // установка бита по индексу
+	void InverseBit(unsigned index); // инверсия бита по индексу
+
+	Genome ShiftRight(unsigned count) const; // сдвиг вправо на count бит
+	Genome Reverse() const; // разворот порядка всех Bits бит
+	double Decode(double left, double step) const; // декодирование в координату left + значение * step
+
+	uint64_t GetHash() const; // получение хэша генома
+	bool operator==(const Genome &genome) const;
+
+	Genome operator&(const Genome &genome) const;
+	Genome operator|(const Genome &genome) const;
+	Genome operator~() const;
+};
+
+template <unsigned Bits>
+const unsigned Genome<Bits>::Words;
+
+template <unsigned Bits>
+const unsigned Genome<Bits>::TopBits;
+
+template <unsigned Bits>
+const uint64_t Genome<Bits>::TopMask;
+
+// получение нулевого генома
+template <unsigned Bits>
+Genome<Bits> Genome<Bits>::GetZero() {
+	Genome genome;
+
+	for (unsigned i = 0; i < Words; i++)
+		genome.words[i] = 0;
+
+	return genome;
+}
+
+// получение случайного генома
+template <unsigned Bits>
+Genome<Bits> Genome<Bits>::GetRandom(Random &random) {
+	Genome genome;
+
+	for (unsigned i = 0; i < Words; i++)
+		genome.words[i] = random.Next();
+
+	genome.words[Words - 1] &= TopMask;
+	return genome;
+}
+
+// получение маски младших count бит
+template <unsigned Bits>
+Genome<Bits> Genome<Bits>::GetLowMask(unsigned count) {
+	Genome genome;
+
+	for (unsigned i = 0; i < Words; i++) {
+		if (count >= 64 * (i + 1)) {
+			genome.words[i] = ~0ULL;
+		}
+		else if (count <= 64 * i) {
+			genome.words[i] = 0;
+		}
+		else {
+			genome.words[i] = (1ULL << (count - 64 * i)) - 1;
+		}
+	}
+
+	genome.words[Words - 1] &= TopMask;
+	return genome;
+}
+
+// получение бита по индексу
+template <unsigned Bits>
+bool Genome<Bits>::GetBit(unsigned index) const {
+	return (words[index / 64] >> (index % 64)) & 1;
+}
+
+// установка бита по индексу
+template <unsigned Bits>
+void Genome<Bits>::SetBit(unsigned index, bool bit) {
+	if (bit) {
+		words[index / 64] |= 1ULL << (index % 64);
+	}
+	else {
+		words[index / 64] &= ~(1ULL << (index % 64));
+	}
+}
+
+// инверсия бита по индексу
+template <unsigned Bits>
+void Genome<Bits>::InverseBit(unsigned index) {
+	words[index / 64] ^= 1ULL << (index % 64);
+}
+
+// сдвиг вправо на count бит
+template <unsigned Bits>
+Genome<Bits> Genome<Bits>::ShiftRight(unsigned count) const {
+	Genome genome;
+	unsigned wordShift = count / 64;
+	unsigned bitShift = count % 64;
+
+	for (unsigned i = 0; i < Words; i++) {
+		uint64_t low = i + wordShift < Words ? words[i + wordShift] : 0;
+		uint64_t high = i + wordShift + 1 < Words ? words[i + wordShift + 1] : 0;
+
+		genome.words[i] = bitShift ? (low >> bitShift) | (high << (64 - bitShift)) : low;
+	}
+
+	return genome;
+}
+
+// разворот порядка всех Bits бит
+template <unsigned Bits>
+Genome<Bits> Genome<Bits>::Reverse() const {
+	Genome genome;
+
+	// разворачиваем все слова целиком, после чего используемые биты оказываются сдвинуты влево
+	for (unsigned i = 0; i < Words; i++)
+		genome.words[i] = ReverseBits(words[Words - 1 - i]);
+
+	return genome.ShiftRight(64 - TopBits);
+}
+
+// декодирование в координату left + значение * step: слова прибавляются от старшего к младшему,
+// поэтому при сокращении старших разрядов с left младшие слова не теряются
+template <unsigned Bits>
+double Genome<Bits>::Decode(double left, double step) const {
+	Value point = left;
+	Value scale = step;
+
+	for (unsigned i = 1; i < Words; i++)
+		scale *= 18446744073709551616.0L; // вес старшего слова step * 2^(64 * (Words - 1))
+
+	for (unsigned i = Words; i > 0; i--) {
+		point += words[i - 1] * scale;
+		scale /= 18446744073709551616.0L;
+	}
+
+	return point;
+}
+
+// получение хэша генома
+template <unsigned Bits>
+uint64_t Genome<Bits>::GetHash() const {
+	uint64_t hash = words[0];
+
+	for (unsigned i = 1; i < Words; i++)
+		hash = (hash ^ (hash >> 29)) * 0xBF58476D1CE4E5B9ULL + words[i];
+
+	return hash;
+}
+
+template <unsigned Bits>
+bool Genome<Bits>::operator==(const Genome &genome) const {
+	for (unsigned i = 0; i < Words; i++)
+		if (words[i] != genome.words[i])
+			return false;
+
+	return true;
+}
+
+template <unsigned Bits>
+Genome<Bits> Genome<Bits>::operator&(const Genome &genome) const {
+	Genome result;
+
+	for (unsigned i = 0; i < Words; i++)
+		result.words[i] = words[i] & genome.words[i];
+
+	return result;
+}
+
+template <unsigned Bits>
+Genome<Bits> Genome<Bits>::operator|(const Genome &genome) const {
+	Genome result;
+
+	for (unsigned i = 0; i < Words; i++)
+		result.words[i] = words[i] | genome.words[i];
+
+	return result;
+}
+
+template <unsigned Bits>
+Genome<Bits> Genome<Bits>::operator~() const {
+	Genome result;
+
+	for (unsigned i = 0; i < Words; i++)
+		result.words[i] = ~words[i];
+
+	result.words[Words - 1] &= TopMask; // неиспользуемые биты остаются нулевыми
+	return result;
+}
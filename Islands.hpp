@@ -0,0 +1,265 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+#include "Config.hpp"
+#include "Population.hpp"
+#include "SpscQueue.hpp"
+
+// итог работы острова
+template <unsigned Bits>
+struct IslandResult {
+	Entity<Bits> best; // лучшая особь острова
+	size_t epochs; // число выполненных эпох
+	size_t sent; // число отправленных мигрантов
+	size_t received; // число принятых мигрантов
+	size_t dropped; // число мигрантов, не поместившихся в очередь получателя
+};
+
+// модель островов: независимые популяции в отдельных потоках, обменивающиеся лучшими особями
+template <unsigned Bits>
+class IslandModel {
+	std::vector<Config> configs; // конфигурации островов
+	size_t islands; // число островов
+	int scale; // множитель для сравнений
+
+	size_t recordWidth; // число слов записи мигранта: оценка и слова всех генов
+	std::vector<std::unique_ptr<SpscQueue<uint64_t>>> queues; // очереди упакованных мигрантов для каждой упорядоченной пары островов
+	std::vector<IslandResult<Bits>> results; // итоги островов
+	std::vector<std::thread> threads; // потоки островов
+
+	std::atomic<double> globalBest; // лучшее значение среди всех островов
+	std::atomic<size_t> finished; // число завершившихся островов
+
+	SpscQueue<uint64_t>& GetQueue(size_t from, size_t to); // получение очереди от острова from к острову to
+	void UpdateGlobalBest(double score); // обновление лучшего значения без блокировок
+	void Receive(size_t island, Population<Bits> &population, std::vector<uint64_t> &record, std::vector<Genome<Bits>> &migrant); // приём мигрантов от всех островов
+	void Send(size_t island, Population<Bits> &population, Random &random, std::vector<uint64_t> &record); // отправка лучших особей соседу
+	void RunIsland(size_t island, BatchFunction f); // эволюция одного острова
+public:
+	IslandModel(const std::vector<Config> &configs); // создание модели по конфигурациям островов
+
+	void Start(BatchFunction f); // запуск островов в отдельных потоках
+	bool IsFinished() const; // завершились ли все острова
+	void Wait(); // ожидание завершения островов
+
+	double GetGlobalBest() const; // получение текущего лучшего значения среди всех островов
+	const std::vector<IslandResult<Bits>>& GetResults() const; // получение итогов островов
+	size_t GetBestIsland() const; // получение номера острова с лучшей особью
+};
+
+// привязка потока к ядру процессора
+void PinThread(std::thread &thread, size_t index) {
+#if defined(__linux__)
+	size_t cores = std::thread::hardware_concurrency();
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cores > 0 ? index % cores : 0, &set);
+	pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set); // при неудаче поток просто не привязывается
+#endif
+}
+
+// создание модели по конфигурациям островов
+template <unsigned Bits>
+IslandModel<Bits>::IslandModel(const std::vector<Config> &configs) : configs(configs), finished(0) {
+	islands = configs.size();
+	scale = configs[0].scale;
+	globalBest = -scale * std::numeric_limits<double>::infinity();
+
+	recordWidth = 1 + configs[0].dimensions * Genome<Bits>::Words;
+	queues.resize(islands * islands);
+	results.resize(islands);
+
+	// у каждой очереди ровно один писатель и один читатель, поэтому обмен обходится без блокировок,
+	// а мигранты передаются записями фиксированного размера и не требуют выделения памяти
+	for (size_t from = 0; from < islands; from++)
+		for (size_t to = 0; to < islands; to++)
+			if (from != to && (configs[from].migrationTopology == MigrationTopology::Random || to == (from + 1) % islands))
+				queues[from * islands + to] = std::unique_ptr<SpscQueue<uint64_t>>(new SpscQueue<uint64_t>(4 * configs[from].migrationSize, recordWidth));
+}
+
+// получение очереди от острова from к острову to
+template <unsigned Bits>
+SpscQueue<uint64_t>& IslandModel<Bits>::GetQueue(size_t from, size_t to) {
+	return *queues[from * islands + to];
+}
+
+// обновление лучшего значения без блокировок
+template <unsigned Bits>
+void IslandModel<Bits>::UpdateGlobalBest(double score) {
+	double current = globalBest.load(std::memory_order_relaxed);
+
+	while ((score - current) * scale > 0 && !globalBest.compare_exchange_weak(current, score, std::memory_order_relaxed))
+		;
+}
+
+// приём мигрантов от всех островов: мигранты замещают худших особей
+template <unsigned Bits>
+void IslandModel<Bits>::Receive(size_t island, Population<Bits> &population, std::vector<uint64_t> &record, std::vector<Genome<Bits>> &migrant) {
+	for (size_t from = 0; from < islands; from++) {
+		if (!queues[from * islands + island])
+			continue;
+
+		// забираем только то, что уже есть в очереди, не дожидаясь отправителя
+		while (GetQueue(from, island).TryPop(record.data())) {
+			double score;
+			memcpy(&score, &record[0], sizeof(double));
+			memcpy(migrant.data(), &record[1], migrant.size() * sizeof(Genome<Bits>));
+			population.Immigrate(configs[island], migrant.data(), score);
+			results[island].received++;
+		}
+	}
+}
+
+// отправка лучших особей соседу по кольцу или случайному острову
+template <unsigned Bits>
+void IslandModel<Bits>::Send(size_t island, Population<Bits> &population, Random &random, std::vector<uint64_t> &record) {
+	const Config &config = configs[island];
+	size_t to = (island + 1) % islands;
+
+	if (config.migrationTopology == MigrationTopology::Random) {
+		to = random.GetInt(islands - 1);
+
+		if (to >= island)
+			to++; // пропускаем сам остров
+	}
+
+	SpscQueue<uint64_t> &queue = GetQueue(island, to);
+	IslandResult<Bits> &result = results[island];
+
+	// запись мигранта: оценка, затем слова всех генов подряд; при заполненной очереди мигранты отбрасываются,
+	// отправитель никогда не ждёт получателя
+	population.ForBestEntities(config, config.migrationSize, [&config, &queue, &result, &record](const Genome<Bits> *genes, double score) {
+		memcpy(&record[0], &score, sizeof(double));
+		memcpy(&record[1], genes, config.dimensions * sizeof(Genome<Bits>));
+
+		if (queue.TryPush(record.data())) {
+			result.sent++;
+		}
+		else {
+			result.dropped++;
+		}
+	});
+}
+
+// эволюция одного острова
+template <unsigned Bits>
+void IslandModel<Bits>::RunIsland(size_t island, BatchFunction f) {
+	const Config &config = configs[island];
+	IslandResult<Bits> &result = results[island];
+
+	Population<Bits> population(config, island); // у каждого острова свой поток случайных чисел
+	Random random(config.seed, islands + island); // поток для выбора получателей мигрантов
+	std::vector<uint64_t> record(recordWidth); // запись мигранта, выделяется один раз
+	std::vector<Genome<Bits>> migrant(config.dimensions); // гены принятого мигранта
+	Entity<Bits> bestEntity; // лучшая особь эпохи, память генов выделяется один раз
+
+	size_t nochangingIterations = 0;
+	double prevBest = 0;
+
+	for (size_t epoch = 0; epoch < config.maxEpochs; epoch++) {
+		population.Eval(config, f); // оцениваем популяцию
+		Receive(island, population, record, migrant); // мигранты уже оценены и не требуют повторной оценки
+
+		population.GetBestEntity(config, bestEntity);
+		double currBest = bestEntity.GetScore();
+
+		if (epoch == 0 || (currBest - result.best.GetScore()) * config.scale > 0)
+			result.best = bestEntity;
+
+		result.epochs = epoch + 1;
+		UpdateGlobalBest(currBest);
+
+		// каждый остров останавливается по собственному критерию
+		if (epoch > 0 && fabs(prevBest - currBest) < config.qualityEpsilon) {
+			if (++nochangingIterations >= config.maxValuelessEpochs)
+				break;
+		}
+		else {
+			nochangingIterations = 0;
+		}
+
+		prevBest = currBest;
+
+		if (islands > 1 && epoch % config.migrationInterval == config.migrationInterval - 1)
+			Send(island, population, random, record);
+
+		population.Selection(config); // запускаем селекцию
+
+		if (config.memeticElites > 0)
+			population.Refine(config, f); // улучшения защищённых особей учитываются при оценке следующей эпохи
+
+		population.Crossbreeding(config); // запускаем скрещивание
+		population.Mutation(config); // запускаем мутацию
+	}
+
+	finished.fetch_add(1, std::memory_order_release);
+}
+
+// запуск островов в отдельных потоках
+template <unsigned Bits>
+void IslandModel<Bits>::Start(BatchFunction f) {
+	for (size_t i = 0; i < islands; i++) {
+		results[i].epochs = 0;
+		results[i].sent = 0;
+		results[i].received = 0;
+		results[i].dropped = 0;
+	}
+
+	for (size_t i = 0; i < islands; i++) {
+		threads.push_back(std::thread(&IslandModel<Bits>::RunIsland, this, i, f));
+
+		if (configs[i].pinThreads)
+			PinThread(threads.back(), i);
+	}
+}
+
+// завершились ли все острова
+template <unsigned Bits>
+bool IslandModel<Bits>::IsFinished() const {
+	return finished.load(std::memory_order_acquire) == islands;
+}
+
+// ожидание завершения островов
+template <unsigned Bits>
+void IslandModel<Bits>::Wait() {
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+
+	threads.clear();
+}
+
+// получение текущего лучшего значения среди всех островов
+template <unsigned Bits>
+double IslandModel<Bits>::GetGlobalBest() const {
+	return globalBest.load(std::memory_order_relaxed);
+}
+
+// получение итогов островов
+template <unsigned Bits>
+const std::vector<IslandResult<Bits>>& IslandModel<Bits>::GetResults() const {
+	return results;
+}
+
+// получение номера острова с лучшей особью
+template <unsigned Bits>
+size_t IslandModel<Bits>::GetBestIsland() const {
+	size_t best = 0;
+
+	for (size_t i = 1; i < islands; i++)
+		if ((results[i].best.GetScore() - results[best].best.GetScore()) * scale > 0)
+			best = i;
+
+	return best;
+}
@@ -4,57 +4,76 @@
 #include "Config.hpp"
 #include "Entity.hpp"
 
+// перестановка битов index1 и index2 генома
+template <unsigned Bits>
+Genome<Bits> SwapMutation(Genome<Bits> bits, unsigned index1, unsigned index2) {
+	// если биты различаются, достаточно инвертировать оба
+	if (bits.GetBit(index1) != bits.GetBit(index2)) {
+		bits.InverseBit(index1);
+		bits.InverseBit(index2);
+	}
+
+	return bits;
+}
+
+// реверс битов генома с index по старший бит
+template <unsigned Bits>
+Genome<Bits> ReverseMutation(const Genome<Bits> &bits, unsigned index) {
+	// разворот сдвинутой вправо части ставит её биты ровно на позиции [index, Bits)
+	return (bits & Genome<Bits>::GetLowMask(index)) | bits.ShiftRight(index).Reverse();
+}
+
 // случайная мутация
-void RandomMutation(Entity &entity) {
-	unsigned index = GetRandom(M); // получаем бит
-	entity.InverseBit(index); // инвертируем заданный бит
+template <unsigned Bits>
+void RandomMutation(Genome<Bits> &gene, Random &random) {
+	unsigned index = random.GetInt(Bits); // получаем бит
+	gene.InverseBit(index); // инвертируем заданный бит
 }
 
 // мутация перестановкой битов
-void SwapMutation(Entity &entity) {
-	unsigned index1 = GetRandom(M); // получаем индекс первого бита
-	unsigned index2 = GetRandom(M); // получаем индекс второго бита
-
-	bool bit1 = entity.GetBit(index1); // получаем первый бит
-	bool bit2 = entity.GetBit(index2); // получаем второй бит
+template <unsigned Bits>
+void SwapMutation(Genome<Bits> &gene, Random &random) {
+	unsigned index1 = random.GetInt(Bits); // получаем индекс первого бита
+	unsigned index2 = random.GetInt(Bits); // получаем индекс второго бита
 
-	// переставляем биты
-	entity.SetBit(bit2, index1);
-	entity.SetBit(bit1, index2);
+	gene = SwapMutation(gene, index1, index2); // переставляем биты
 }
 
 // мутация реверсом части битов
-void ReverseMutation(Entity &entity) {
-	unsigned i = GetRandom(M); // получаем бит
-	unsigned j = M - 1; // правая граница - последний бит
-
-	// пока не схлопнутся границы
-	while (i < j) {
-		// получаем биты
-		bool biti = entity.GetBit(i);
-		bool bitj = entity.GetBit(j);
-
-		// проставляем биты в нужные места
-		entity.SetBit(j, biti);
-		entity.SetBit(i, bitj);
-
-		// сдвигаем границы
-		i++;
-		j--;
+template <unsigned Bits>
+void ReverseMutation(Genome<Bits> &gene, Random &random) {
+	unsigned index = random.GetInt(Bits); // получаем бит, правая граница - последний бит
+	gene = ReverseMutation(gene, index);
+}
+
+// мутация особи из dimensions генов видом, известным при компиляции: мутирует один случайный ген
+template <MutationType Type, unsigned Bits>
+void Mutate(Genome<Bits> *genes, size_t dimensions, Random &random) {
+	Genome<Bits> &gene = genes[dimensions > 1 ? random.GetInt(dimensions) : 0];
+
+	if (Type == MutationType::Random) {
+		RandomMutation(gene, random);
+	}
+	else if (Type == MutationType::Swap) {
+		SwapMutation(gene, random);
+	}
+	else {
+		ReverseMutation(gene, random);
 	}
 }
 
-// мутация в зависимости от режима
-void Mutate(Entity &entity, MutationType type) {
+// мутация особи из dimensions генов в зависимости от режима: мутирует один случайный ген
+template <unsigned Bits>
+void Mutate(Genome<Bits> *genes, size_t dimensions, MutationType type, Random &random) {
 	if (type == MutationType::Random) {
-		RandomMutation(entity);
+		Mutate<MutationType::Random>(genes, dimensions, random);
 	}
 	else if (type == MutationType::Swap) {
-		SwapMutation(entity);
+		Mutate<MutationType::Swap>(genes, dimensions, random);
 	}
 	else if (type == MutationType::Reverse) {
-		ReverseMutation(entity);
+		Mutate<MutationType::Reverse>(genes, dimensions, random);
 	}
 	else
 		throw std::runtime_error("unhandled MutationType");
-}
\ No newline at end of file
+}
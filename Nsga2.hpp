@@ -0,0 +1,276 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+#include "Config.hpp"
+#include "Random.hpp"
+#include "Entity.hpp"
+#include "Crossbreeding.hpp"
+#include "Mutation.hpp"
+#include "Pareto.hpp"
+#include "GeneticAlgorithm.hpp"
+
+// точка фронта Парето: координаты и значения целей
+struct ParetoPoint {
+	std::vector<double> x; // точка пространства поиска
+	std::vector<double> scores; // значения целей
+};
+
+// многокритериальный генетический алгоритм NSGA-II: потомки родителей, отобранных турниром по номеру фронта и расстоянию скученности,
+// оцениваются вместе с родителями, и следующее поколение заполняется фронтами по порядку, а последний помещающийся фронт - самыми
+// удалёнными от соседей точками
+// Fitness - пакетная функция (const double *x, double *scores, size_t n, size_t dimensions), записывающая цели точки i в scores[i * objectives ...]
+// направление (config.mode) общее для всех целей, критерий остановки - только max_epochs
+template <unsigned Bits, typename Fitness>
+class Nsga2Algorithm {
+public:
+	typedef std::function<void(Nsga2Algorithm&)> Callback; // обработчик эпохи
+
+private:
+	Config config; // конфигурация
+	Fitness fitness; // оценочная функция
+	size_t dimensions; // число генов особи
+	size_t objectives; // число целей
+	size_t size; // размер популяции
+	Random random; // поток случайных чисел
+
+	// первые size особей - родители, следующие size - потомки
+	std::vector<Genome<Bits>> genes; // гены особей
+	std::vector<double> scores; // значения целей особей
+	std::vector<double> costs; // затраты (значения целей, приведённые к минимизации)
+	std::vector<size_t> ranks; // номера фронтов особей
+	std::vector<double> distances; // расстояния скученности особей
+
+	std::vector<Genome<Bits>> nextGenes; // гены следующего поколения
+	std::vector<double> nextScores; // значения целей следующего поколения
+	std::vector<double> xs; // декодированные точки оцениваемых особей
+
+	size_t epoch; // число завершённых эпох
+	size_t fronts; // число фронтов на последней сортировке
+	StopReason reason; // причина остановки
+	std::vector<Callback> epochEndCallbacks; // обработчики конца эпохи
+
+	void Eval(size_t begin, size_t end); // оценка особей [begin, end)
+	size_t SelectParent(); // отбор родителя бинарным турниром
+	void MakeOffspring(); // построение потомков на местах [size, 2 * size)
+	void SelectNext(size_t count); // сортировка count особей и отбор size из них в следующее поколение
+public:
+	Nsga2Algorithm(const Config &config, Fitness fitness, size_t stream = 0); // создание алгоритма со случайной популяцией
+
+	void OnEpochEnd(const Callback &callback); // добавление обработчика, вызываемого после отбора следующего поколения
+	bool Step(); // выполнение одной эпохи, false после остановки
+	void Run(); // выполнение эпох до остановки
+	void Stop(); // остановка алгоритма после текущей эпохи
+
+	size_t GetEpoch() const; // получение числа завершённых эпох
+	size_t GetFronts() const; // получение числа фронтов популяции
+	StopReason GetStopReason() const; // получение причины остановки
+	std::vector<ParetoPoint> GetFront() const; // получение различных недоминируемых точек популяции по возрастанию первой цели
+};
+
+// создание алгоритма со случайной популяцией
+template <unsigned Bits, typename Fitness>
+Nsga2Algorithm<Bits, Fitness>::Nsga2Algorithm(const Config &config, Fitness fitness, size_t stream) : config(config), fitness(fitness), random(config.seed, stream) {
+	dimensions = config.dimensions;
+	objectives = config.objectives;
+	size = config.populationSize;
+
+	genes.resize(2 * size * dimensions);
+	scores.resize(2 * size * objectives);
+	costs.resize(2 * size * objectives);
+	ranks.resize(2 * size);
+	distances.resize(2 * size);
+	nextGenes.resize(size * dimensions);
+	nextScores.resize(size * objectives);
+	xs.resize(size * dimensions);
+
+	for (size_t i = 0; i < size * dimensions; i++)
+		genes[i] = Genome<Bits>::GetRandom(random);
+
+	epoch = 0;
+	fronts = 0;
+	reason = StopReason::None;
+
+	Eval(0, size);
+	SelectNext(size); // ранги и расстояния начальной популяции для первого турнира
+}
+
+// оценка особей [begin, end) одним пакетом
+template <unsigned Bits, typename Fitness>
+void Nsga2Algorithm<Bits, Fitness>::Eval(size_t begin, size_t end) {
+	for (size_t i = begin; i < end; i++)
+		Decode(config, &genes[i * dimensions], &xs[(i - begin) * dimensions]);
+
+	fitness(xs.data(), &scores[begin * objectives], end - begin, dimensions);
+
+	for (size_t i = begin * objectives; i < end * objectives; i++)
+		costs[i] = -config.scale * scores[i];
+}
+
+// отбор родителя бинарным турниром: меньший номер фронта, при равенстве - большее расстояние скученности
+template <unsigned Bits, typename Fitness>
+size_t Nsga2Algorithm<Bits, Fitness>::SelectParent() {
+	size_t a = random.GetInt(size);
+	size_t b = random.GetInt(size);
+
+	if (ranks[b] < ranks[a] || (ranks[b] == ranks[a] && distances[b] > distances[a]))
+		return b;
+
+	return a;
+}
+
+// построение потомков на местах [size, 2 * size)
+template <unsigned Bits, typename Fitness>
+void Nsga2Algorithm<Bits, Fitness>::MakeOffspring() {
+	for (size_t i = size; i < 2 * size; i++) {
+		const Genome<Bits> *parent1 = &genes[SelectParent() * dimensions];
+		const Genome<Bits> *parent2 = &genes[SelectParent() * dimensions];
+		Genome<Bits> *child = &genes[i * dimensions];
+
+		Crossbreed(parent1, parent2, child, dimensions, config.crossbreedingType, random);
+
+		if (random.GetReal() < config.mutationProbability)
+			Mutate(child, dimensions, config.mutationType, random);
+	}
+}
+
+// сортировка count особей и отбор size из них в следующее поколение
+template <unsigned Bits, typename Fitness>
+void Nsga2Algorithm<Bits, Fitness>::SelectNext(size_t count) {
+	fronts = NonDominatedSort(costs.data(), count, objectives, ranks);
+
+	std::vector<std::vector<size_t>> members(fronts);
+
+	for (size_t i = 0; i < count; i++)
+		members[ranks[i]].push_back(i);
+
+	std::vector<size_t> selected;
+
+	// фронты берутся целиком, пока помещаются, из последнего - самые удалённые от соседей особи
+	for (size_t front = 0; front < fronts && selected.size() < size; front++) {
+		std::vector<size_t> &indices = members[front];
+		CrowdingDistance(costs.data(), objectives, indices, distances);
+
+		if (selected.size() + indices.size() > size) {
+			std::stable_sort(indices.begin(), indices.end(), [this](size_t i, size_t j) {
+				return distances[i] > distances[j];
+			});
+
+			indices.resize(size - selected.size());
+		}
+
+		selected.insert(selected.end(), indices.begin(), indices.end());
+	}
+
+	std::vector<size_t> nextRanks(size);
+	std::vector<double> nextDistances(size);
+
+	for (size_t i = 0; i < size; i++) {
+		size_t index = selected[i];
+
+		std::copy(genes.begin() + index * dimensions, genes.begin() + (index + 1) * dimensions, nextGenes.begin() + i * dimensions);
+		std::copy(scores.begin() + index * objectives, scores.begin() + (index + 1) * objectives, nextScores.begin() + i * objectives);
+		nextRanks[i] = ranks[index];
+		nextDistances[i] = distances[index];
+	}
+
+	std::copy(nextGenes.begin(), nextGenes.end(), genes.begin());
+	std::copy(nextScores.begin(), nextScores.end(), scores.begin());
+	std::copy(nextRanks.begin(), nextRanks.end(), ranks.begin());
+	std::copy(nextDistances.begin(), nextDistances.end(), distances.begin());
+
+	for (size_t i = 0; i < size * objectives; i++)
+		costs[i] = -config.scale * scores[i];
+}
+
+// добавление обработчика, вызываемого после отбора следующего поколения
+template <unsigned Bits, typename Fitness>
+void Nsga2Algorithm<Bits, Fitness>::OnEpochEnd(const Callback &callback) {
+	epochEndCallbacks.push_back(callback);
+}
+
+// выполнение одной эпохи, false после остановки
+template <unsigned Bits, typename Fitness>
+bool Nsga2Algorithm<Bits, Fitness>::Step() {
+	if (reason == StopReason::None && epoch >= config.maxEpochs)
+		reason = StopReason::MaxEpochs;
+
+	if (reason != StopReason::None)
+		return false;
+
+	MakeOffspring();
+	Eval(size, 2 * size); // оцениваются только потомки, значения родителей уже известны
+	SelectNext(2 * size);
+	epoch++;
+
+	for (size_t i = 0; i < epochEndCallbacks.size(); i++)
+		epochEndCallbacks[i](*this);
+
+	if (reason == StopReason::None && epoch >= config.maxEpochs)
+		reason = StopReason::MaxEpochs;
+
+	return reason == StopReason::None;
+}
+
+// выполнение эпох до остановки
+template <unsigned Bits, typename Fitness>
+void Nsga2Algorithm<Bits, Fitness>::Run() {
+	while (Step())
+		;
+}
+
+// остановка алгоритма после текущей эпохи
+template <unsigned Bits, typename Fitness>
+void Nsga2Algorithm<Bits, Fitness>::Stop() {
+	if (reason == StopReason::None)
+		reason = StopReason::Stopped;
+}
+
+// получение числа завершённых эпох
+template <unsigned Bits, typename Fitness>
+size_t Nsga2Algorithm<Bits, Fitness>::GetEpoch() const {
+	return epoch;
+}
+
+// получение числа фронтов популяции
+template <unsigned Bits, typename Fitness>
+size_t Nsga2Algorithm<Bits, Fitness>::GetFronts() const {
+	return fronts;
+}
+
+// получение причины остановки
+template <unsigned Bits, typename Fitness>
+StopReason Nsga2Algorithm<Bits, Fitness>::GetStopReason() const {
+	return reason;
+}
+
+// получение различных недоминируемых точек популяции по возрастанию первой цели
+template <unsigned Bits, typename Fitness>
+std::vector<ParetoPoint> Nsga2Algorithm<Bits, Fitness>::GetFront() const {
+	std::vector<ParetoPoint> front;
+
+	for (size_t i = 0; i < size; i++) {
+		if (ranks[i] != 0)
+			continue;
+
+		ParetoPoint point;
+		point.x.resize(dimensions);
+		point.scores.assign(scores.begin() + i * objectives, scores.begin() + (i + 1) * objectives);
+		Decode(config, &genes[i * dimensions], point.x.data());
+		front.push_back(point);
+	}
+
+	std::sort(front.begin(), front.end(), [](const ParetoPoint &a, const ParetoPoint &b) {
+		return a.scores < b.scores || (a.scores == b.scores && a.x < b.x);
+	});
+
+	// одна и та же точка может встречаться в популяции несколько раз
+	front.erase(std::unique(front.begin(), front.end(), [](const ParetoPoint &a, const ParetoPoint &b) {
+		return a.scores == b.scores && a.x == b.x;
+	}), front.end());
+
+	return front;
+}
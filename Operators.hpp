@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Config.hpp"
+
+// направление оптимизации, известное при компиляции
+struct Maximize {
+	static const int Scale = 1; // множитель для сравнений
+};
+
+struct Minimize {
+	static const int Scale = -1; // множитель для сравнений
+};
+
+// операторы, выбираемые по конфигурации во время работы (подходят для любой конфигурации)
+struct RuntimeOperators {
+	static SelectionType GetSelection(const Config &config); // получение типа отбора
+	static CrossbreedingType GetCrossbreeding(const Config &config); // получение типа скрещивания
+	static MutationType GetMutation(const Config &config); // получение типа мутации
+	static int GetScale(const Config &config); // получение множителя для сравнений
+	static bool Matches(const Config &config); // подходят ли операторы для конфигурации
+};
+
+// операторы и направление, известные при компиляции: все проверки типа в популяции сворачиваются в константы
+template <SelectionType Selection, CrossbreedingType Crossbreeding, MutationType Mutation, typename Direction>
+struct StaticOperators {
+	static SelectionType GetSelection(const Config &config); // получение типа отбора
+	static CrossbreedingType GetCrossbreeding(const Config &config); // получение типа скрещивания
+	static MutationType GetMutation(const Config &config); // получение типа мутации
+	static int GetScale(const Config &config); // получение множителя для сравнений
+	static bool Matches(const Config &config); // подходят ли операторы для конфигурации
+};
+
+// список наборов операторов
+template <typename... Operators>
+struct OperatorsList {};
+
+// заранее инстанцированные комбинации (операторы из config.txt в обоих направлениях): каждая комбинация
+// добавляет ещё одну копию популяции и цикла эпох для каждого размера генома, поэтому список короткий
+typedef OperatorsList<
+	StaticOperators<SelectionType::Roullete, CrossbreedingType::TwoPoint, MutationType::Reverse, Maximize>,
+	StaticOperators<SelectionType::Roullete, CrossbreedingType::TwoPoint, MutationType::Reverse, Minimize>
+> SpecializedOperators;
+
+// получение типа отбора
+SelectionType RuntimeOperators::GetSelection(const Config &config) {
+	return config.selectionType;
+}
+
+// получение типа скрещивания
+CrossbreedingType RuntimeOperators::GetCrossbreeding(const Config &config) {
+	return config.crossbreedingType;
+}
+
+// получение типа мутации
+MutationType RuntimeOperators::GetMutation(const Config &config) {
+	return config.mutationType;
+}
+
+// получение множителя для сравнений
+int RuntimeOperators::GetScale(const Config &config) {
+	return config.scale;
+}
+
+// подходят ли операторы для конфигурации
+bool RuntimeOperators::Matches(const Config&) {
+	return true;
+}
+
+// получение типа отбора
+template <SelectionType Selection, CrossbreedingType Crossbreeding, MutationType Mutation, typename Direction>
+SelectionType StaticOperators<Selection, Crossbreeding, Mutation, Direction>::GetSelection(const Config&) {
+	return Selection;
+}
+
+// получение типа скрещивания
+template <SelectionType Selection, CrossbreedingType Crossbreeding, MutationType Mutation, typename Direction>
+CrossbreedingType StaticOperators<Selection, Crossbreeding, Mutation, Direction>::GetCrossbreeding(const Config&) {
+	return Crossbreeding;
+}
+
+// получение типа мутации
+template <SelectionType Selection, CrossbreedingType Crossbreeding, MutationType Mutation, typename Direction>
+MutationType StaticOperators<Selection, Crossbreeding, Mutation, Direction>::GetMutation(const Config&) {
+	return Mutation;
+}
+
+// получение множителя для сравнений
+template <SelectionType Selection, CrossbreedingType Crossbreeding, MutationType Mutation, typename Direction>
+int StaticOperators<Selection, Crossbreeding, Mutation, Direction>::GetScale(const Config&) {
+	return Direction::Scale;
+}
+
+// подходят ли операторы для конфигурации
+template <SelectionType Selection, CrossbreedingType Crossbreeding, MutationType Mutation, typename Direction>
+bool StaticOperators<Selection, Crossbreeding, Mutation, Direction>::Matches(const Config &config) {
+	return config.selectionType == Selection && config.crossbreedingType == Crossbreeding && config.mutationType == Mutation && config.scale == Direction::Scale;
+}
+
+// ни одна комбинация не подошла - выполняем общую реализацию
+template <typename Action>
+void DispatchOperators(const Config&, Action &action, OperatorsList<>) {
+	action.template Run<RuntimeOperators>();
+}
+
+// выбор первой подходящей под конфигурацию комбинации операторов и вызов action.Run<Operators>() с ней
+template <typename Action, typename First, typename... Rest>
+void DispatchOperators(const Config &config, Action &action, OperatorsList<First, Rest...>) {
+	if (First::Matches(config)) {
+		action.template Run<First>();
+	}
+	else {
+		DispatchOperators(config, action, OperatorsList<Rest...>());
+	}
+}
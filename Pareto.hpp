@@ -0,0 +1,162 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+// сортировка по недоминированию и расстояние скученности для многокритериальной оптимизации
+// все функции работают с затратами: n точек по objectives значений подряд, меньшее значение лучше
+
+// доминирует ли точка a над точкой b: не хуже по всем целям и лучше хотя бы по одной
+bool Dominates(const double *a, const double *b, size_t objectives) {
+	bool better = false;
+
+	for (size_t k = 0; k < objectives; k++) {
+		if (a[k] > b[k])
+			return false;
+
+		if (a[k] < b[k])
+			better = true;
+	}
+
+	return better;
+}
+
+// получение номеров точек в лексикографическом порядке затрат: ни одна точка не доминирует над предшествующими
+std::vector<size_t> GetLexicographicOrder(const double *costs, size_t n, size_t objectives) {
+	std::vector<size_t> order(n);
+
+	for (size_t i = 0; i < n; i++)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [costs, objectives](size_t i, size_t j) {
+		const double *a = costs + i * objectives;
+		const double *b = costs + j * objectives;
+
+		for (size_t k = 0; k < objectives; k++)
+			if (a[k] != b[k])
+				return a[k] < b[k];
+
+		return i < j;
+	});
+
+	return order;
+}
+
+// сортировка по двум целям за O(N log N): в лексикографическом порядке вторая цель вдоль фронта не возрастает,
+// поэтому доминирование над точкой проверяется по последней точке фронта, а фронт ищется двоичным поиском
+size_t NonDominatedSort2(const double *costs, size_t n, std::vector<size_t> &ranks) {
+	std::vector<size_t> order = GetLexicographicOrder(costs, n, 2);
+	std::vector<size_t> last; // последняя точка каждого фронта
+
+	ranks.resize(n);
+
+	for (size_t i = 0; i < n; i++) {
+		const double *q = costs + order[i] * 2;
+
+		// все точки фронта не хуже q по первой цели, поэтому q доминируема фронтом, если последняя точка не хуже по второй
+		// (при равенстве второй цели точки фронта с ней совпадают с последней, и q доминируема, только если она хуже по первой)
+		size_t left = 0;
+		size_t right = last.size();
+
+		while (left < right) {
+			size_t middle = (left + right) / 2;
+			const double *p = costs + last[middle] * 2;
+
+			if (p[1] < q[1] || (p[1] == q[1] && p[0] < q[0]))
+				left = middle + 1;
+			else
+				right = middle;
+		}
+
+		if (left == last.size())
+			last.push_back(order[i]);
+		else
+			last[left] = order[i];
+
+		ranks[order[i]] = left;
+	}
+
+	return last.size();
+}
+
+// эффективная сортировка с двоичным поиском фронта (ENS-BS) для любого числа целей: точки обрабатываются в лексикографическом
+// порядке, поэтому точку могут доминировать только уже распределённые, а доминируемость фронтом монотонна по номеру фронта;
+// точка сравнивается только с точками проверяемых фронтов (с конца фронта, где точки ближе к ней), а не со всеми остальными
+size_t EfficientNonDominatedSort(const double *costs, size_t n, size_t objectives, std::vector<size_t> &ranks) {
+	std::vector<size_t> order = GetLexicographicOrder(costs, n, objectives);
+	std::vector<std::vector<size_t>> fronts;
+
+	ranks.resize(n);
+
+	for (size_t i = 0; i < n; i++) {
+		const double *q = costs + order[i] * objectives;
+		size_t left = 0;
+		size_t right = fronts.size();
+
+		while (left < right) {
+			size_t middle = (left + right) / 2;
+			const std::vector<size_t> &front = fronts[middle];
+			bool dominated = false;
+
+			for (size_t j = front.size(); j > 0 && !dominated; j--)
+				dominated = Dominates(costs + front[j - 1] * objectives, q, objectives);
+
+			if (dominated)
+				left = middle + 1;
+			else
+				right = middle;
+		}
+
+		if (left == fronts.size())
+			fronts.push_back(std::vector<size_t>());
+
+		fronts[left].push_back(order[i]);
+		ranks[order[i]] = left;
+	}
+
+	return fronts.size();
+}
+
+// сортировка по недоминированию: ranks[i] - номер фронта точки i (0 - недоминируемые), возвращает число фронтов
+size_t NonDominatedSort(const double *costs, size_t n, size_t objectives, std::vector<size_t> &ranks) {
+	if (objectives == 2)
+		return NonDominatedSort2(costs, n, ranks);
+
+	return EfficientNonDominatedSort(costs, n, objectives, ranks);
+}
+
+// расчёт расстояния скученности точек одного фронта: сумма по целям расстояний между соседями, отнесённых к размаху цели
+// крайние точки получают бесконечное расстояние, чтобы границы фронта всегда сохранялись
+void CrowdingDistance(const double *costs, size_t objectives, const std::vector<size_t> &front, std::vector<double> &distances) {
+	std::vector<size_t> order(front);
+
+	for (size_t i = 0; i < front.size(); i++)
+		distances[front[i]] = 0;
+
+	if (front.size() < 3) {
+		for (size_t i = 0; i < front.size(); i++)
+			distances[front[i]] = std::numeric_limits<double>::infinity();
+
+		return;
+	}
+
+	for (size_t k = 0; k < objectives; k++) {
+		std::sort(order.begin(), order.end(), [costs, objectives, k](size_t i, size_t j) {
+			return costs[i * objectives + k] < costs[j * objectives + k] || (costs[i * objectives + k] == costs[j * objectives + k] && i < j);
+		});
+
+		double low = costs[order.front() * objectives + k];
+		double high = costs[order.back() * objectives + k];
+
+		distances[order.front()] = std::numeric_limits<double>::infinity();
+		distances[order.back()] = std::numeric_limits<double>::infinity();
+
+		if (high == low)
+			continue;
+
+		for (size_t i = 1; i + 1 < order.size(); i++)
+			distances[order[i]] += (costs[order[i + 1] * objectives + k] - costs[order[i - 1] * objectives + k]) / (high - low);
+	}
+}
@@ -2,105 +2,642 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
 
 #include "Config.hpp"
+#include "ThreadPool.hpp"
+#include "FitnessCache.hpp"
 #include "Entity.hpp"
 #include "Crossbreeding.hpp"
 #include "Mutation.hpp"
+#include "Profiler.hpp"
+#include "Telemetry.hpp"
+#include "Checkpoint.hpp"
+#include "Operators.hpp"
+#include "Diversity.hpp"
+
+// оценочная функция: по точке x из dimensions координат возвращает значение
+typedef double (*Function)(const double *x, size_t dimensions);
 
+// пакетная оценочная функция: по n точкам x (по dimensions координат подряд) заполняет массив scores
+typedef void (*BatchFunction)(const double *x, double *scores, size_t n, size_t dimensions);
+
+// популяция; Operators - набор операторов и направление оптимизации (RuntimeOperators - выбор по конфигурации во время работы)
+template <unsigned Bits, typename Operators = RuntimeOperators>
 class Population {
-	std::vector<Entity> entities; // вектор особей
+	size_t dimensions; // число генов особи
+
+	// гены всех особей хранятся подряд: особь i занимает genes[i * dimensions ... (i + 1) * dimensions)
+	std::vector<Genome<Bits>> genes; // гены особей
+	std::vector<double> scores; // оценки приспособленности особей
+	std::vector<bool> dirty; // изменились ли гены особей после последней оценки
+
+	// буферы для построения следующего поколения
+	std::vector<Genome<Bits>> nextGenes;
+	std::vector<double> nextScores;
+	std::vector<bool> nextDirty;
+
+	std::unique_ptr<ThreadPool> pool; // пул потоков для параллельной оценки
+	Random random; // собственный поток случайных чисел популяции
+
+	FitnessCache<Genome<Bits>> cache; // кэш значений оценочной функции
+	std::vector<size_t> pending; // индексы особей, требующих оценки
+	std::vector<double> xs; // декодированные точки особей
+	std::vector<double> values; // значения оценочной функции
+
+	size_t evaluations; // число вызовов оценочной функции на последней оценке
+	size_t cacheHits; // число попаданий в кэш на последней оценке
+	size_t cacheMisses; // число промахов кэша на последней оценке
+	size_t localEvaluations; // число вызовов оценочной функции на последнем локальном поиске
 
+	std::vector<size_t> order; // индексы особей для частичного упорядочивания
+	std::vector<size_t> parents; // индексы защищённых и отобранных особей
+	std::vector<size_t> indices; // индексы участников турниров
+	std::vector<double> fitness; // значения фитнес функции
+	std::vector<size_t> first; // индексы первых родителей потомков
+	std::vector<size_t> second; // индексы вторых родителей потомков
+	std::vector<unsigned> draws; // случайные числа для скрещивания
+	std::vector<double> lefts; // левые границы по измерениям
+	std::vector<double> steps; // шаги декодирования по измерениям
+	EpochStatistics statistics; // показатели текущей эпохи
+	Diversity<Bits> diversity; // разнообразие генов (рассчитывается по запросу)
+	std::vector<size_t> flips; // измерения, в которых инвертирован бит оцениваемых соседей при локальном поиске
+	std::vector<double> point; // декодированная точка улучшаемой особи
+	std::vector<Genome<Bits>> optima; // гены особей, для которых локальный поиск завершился на текущей эпохе (подряд по dimensions)
+	std::vector<Genome<Bits>> previousOptima; // гены особей, для которых локальный поиск завершился на предыдущей эпохе
+
+	template <typename T>
+	void Reserve(std::vector<T> &buffer, size_t size); // подготовка буфера нужного размера
+	void Copy(size_t from, size_t to); // копирование особи в буфер следующего поколения
+	void SwapBuffers(); // смена ролей буферов поколений
+
+	size_t CollectPending(const Config &config); // отбор особей, требующих оценки, с подстановкой значений из кэша
+	template <typename Task>
+	void ForPending(const Config &config, size_t count, const Task &task); // запуск обработки отобранных особей
+	void UpdateCache(size_t count); // сохранение новых оценок в кэш
+	void Decode(const Config &config, size_t begin, size_t end); // декодирование отобранных особей в точки пространства поиска
+	int GetWord(size_t index) const; // получение младшего слова гена
+
+	bool IsBetter(const Config &config, size_t i, size_t j) const; // лучше ли особь i особи j
+	void SelectBest(const Config &config, size_t k); // отбор индексов k лучших особей
 	void PreserveBestEntities(const Config& config); // сохранение лучших особей
-	std::vector<double> GetFitness(const Config& config); // расчёт фитнес функции в зависимости от оценочной функции
+	void GetFitness(const Config& config); // расчёт фитнес функции в зависимости от оценочной функции
+
+	void RandomSelection(const Config& config); // случайный отбор
+	void TournamentSelection(const Config& config); // отбор турниром
+	void RoulleteSelection(const Config& config); // отбор рулеткой
+	void CutSelection(const Config& config); // отбор усечением
 
-	std::vector<Entity> RandomSelection(const Config& config); // случайный отбор
-	std::vector<Entity> TournamentSelection(const Config& config); // отбор турниром
-	std::vector<Entity> RoulleteSelection(const Config& config); // отбор рулеткой
-	std::vector<Entity> CutSelection(const Config& config); // отбор усечением
+	template <MutationType Type>
+	void Mutation(const Config &config); // мутация особей видом, известным при компиляции
+
+	double GetSelectionPressure(const Config &config) const; // расчёт интенсивности отбора
+	size_t CountDuplicates(size_t offset, size_t count) const; // подсчёт потомков, совпавших с одним из родителей
+
+	bool IsClimbed(const Genome<Bits> *entity) const; // завершался ли локальный поиск на особи с такими генами
+	template <typename Evaluate>
+	void Climb(const Config &config, const Evaluate &evaluate); // локальный поиск по битам у лучших защищённых особей
 
 public:
-	Population(int populationSize); // создание популяции заданного размера
+	Population(const Config &config, size_t stream = 0); // создание популяции по конфигурации с заданным потоком случайных чисел
+
+	template <typename Fitness>
+	void Eval(const Config &config, const Fitness &f); // оценка приспособленности особей функцией, функтором или лямбдой от точки
+	void Eval(const Config &config, BatchFunction f); // пакетная оценка приспособленности особей
+	size_t GetEvaluations() const; // получение числа вызовов оценочной функции на последней оценке
+	size_t GetCacheHits() const; // получение числа попаданий в кэш на последней оценке
+	size_t GetCacheMisses() const; // получение числа промахов кэша на последней оценке
+	size_t GetLocalEvaluations() const; // получение числа вызовов оценочной функции на последнем локальном поиске
+	const EpochStatistics& GetStatistics() const; // получение показателей эпохи
+	void ResetStatistics(); // обнуление показателей эпохи
+	void GetTelemetry(const Config &config, size_t epoch, bool snapshot, TelemetryRecord &record) const; // заполнение записи телеметрии по оценённой популяции
+	const Diversity<Bits>& UpdateDiversity(const Config &config); // расчёт разнообразия текущих генов за один проход
+	const Diversity<Bits>& GetDiversity() const; // получение последнего рассчитанного разнообразия
+
+	void SaveCheckpoint(const std::string &path, const Config &config, const CheckpointState &state) const; // сохранение снимка популяции
+	void LoadCheckpoint(const Config &config, const Checkpoint &checkpoint); // восстановление популяции из снимка
 
-	void Eval(const Config &config, double (*f)(double x)); // оценка приспособленности особей
-	void Sort(const Config &config); // упорядочивание по возрастанию приспособленности
-	Entity GetBestEntity(const Config& config) const; // получение самой приспособленной особи
+	void Sort(const Config &config); // упорядочивание по убыванию приспособленности
+	Entity<Bits> GetBestEntity(const Config& config) const; // получение самой приспособленной особи
+	void GetBestEntity(const Config& config, Entity<Bits> &entity) const; // копирование самой приспособленной особи в entity без выделения памяти
+	void GetBestEntities(const Config &config, size_t count, std::vector<Entity<Bits>> &entities); // получение count лучших особей
+	template <typename Sink>
+	void ForBestEntities(const Config &config, size_t count, const Sink &sink); // передача генов и оценок count лучших особей (от лучшей к худшей) без копирования в особи
+	void Immigrate(const Config &config, const Entity<Bits> &entity); // замена худшей особи оценённой особью извне
+	void Immigrate(const Config &config, const Genome<Bits> *entity, double score); // замена худшей особи оценённой особью извне по генам и оценке
 
 	void Selection(const Config& config); // отбор
 	void Crossbreeding(const Config &config); // скрещивание
 	void Mutation(const Config &config); // мутация
+	void Reseed(const Config &config); // замена незащищённых особей случайными
 
-	friend std::ostream& operator<<(std::ostream& os, const Population& population); // вывод популяции
+	template <typename Fitness>
+	void Refine(const Config &config, const Fitness &f); // локальный поиск у лучших защищённых особей функцией, функтором или лямбдой от точки
+	void Refine(const Config &config, BatchFunction f); // локальный поиск у лучших защищённых особей пакетной функцией
+
+	template <unsigned B, typename O>
+	friend std::ostream& operator<<(std::ostream& os, const Population<B, O>& population); // вывод популяции
 };
 
-// создание популяции заданного размера
-Population::Population(int populationSize) {
-	for (int i = 0; i < populationSize; i++)
-		entities.push_back(Entity()); // добавляем особи
+// создание популяции по конфигурации с заданным потоком случайных чисел
+template <unsigned Bits, typename Operators>
+Population<Bits, Operators>::Population(const Config &config, size_t stream) : random(config.seed, stream), cache(config.cacheSize, config.dimensions), diversity(config.dimensions) {
+	dimensions = config.dimensions;
+	genes.resize(config.populationSize * dimensions);
+
+	for (size_t i = 0; i < genes.size(); i++)
+		genes[i] = Genome<Bits>::GetRandom(random); // генерируем случайные гены
+
+	scores.assign(config.populationSize, 0);
+	dirty.assign(config.populationSize, true);
+
+	// все буферы выделяются заранее, поэтому эпохи обходятся без выделения памяти
+	nextGenes.resize(genes.size());
+	nextScores.resize(config.populationSize);
+	nextDirty.resize(config.populationSize);
+	pending.resize(config.populationSize);
+	order.resize(config.populationSize);
+	parents.resize(config.selectionSize);
+	indices.resize(config.selectionSize * config.tournamentSize);
+	fitness.resize(config.populationSize);
+	first.resize(config.populationSize);
+	second.resize(config.populationSize);
+	draws.resize(2 * config.populationSize);
+	xs.resize(config.populationSize * dimensions);
+	values.resize(config.populationSize);
+	lefts.resize(dimensions);
+	steps.resize(dimensions);
+
+	// потоки создаются один раз и переиспользуются на всех эпохах
+	if (config.threads > 1)
+		pool = std::unique_ptr<ThreadPool>(new ThreadPool(config.threads));
+
+	evaluations = 0;
+	cacheHits = 0;
+	cacheMisses = 0;
+	localEvaluations = 0;
 }
 
-// оценка приспособленности особей
-void Population::Eval(const Config &config, double (*f)(double x)) {
-	for (size_t i = 0; i < config.populationSize; i++)
-		entities[i].Score(f, config.leftBorder, config.rightBorder);
+// подготовка буфера нужного размера
+template <unsigned Bits, typename Operators>
+template <typename T>
+void Population<Bits, Operators>::Reserve(std::vector<T> &buffer, size_t size) {
+	// буферы выделяются в конструкторе, память выделяется, только если размеры из конфигурации изменились
+	if (buffer.size() < size)
+		buffer.resize(size);
+}
+
+// копирование особи в буфер следующего поколения
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Copy(size_t from, size_t to) {
+	std::copy(genes.begin() + from * dimensions, genes.begin() + (from + 1) * dimensions, nextGenes.begin() + to * dimensions);
+	nextScores[to] = scores[from];
+	nextDirty[to] = dirty[from];
+}
+
+// смена ролей буферов поколений (без копирования)
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::SwapBuffers() {
+	genes.swap(nextGenes);
+	scores.swap(nextScores);
+	dirty.swap(nextDirty);
+}
+
+// отбор особей, требующих оценки, с подстановкой значений из кэша
+template <unsigned Bits, typename Operators>
+size_t Population<Bits, Operators>::CollectPending(const Config &config) {
+	Reserve(pending, config.populationSize);
+	Reserve(xs, config.populationSize * dimensions);
+	Reserve(values, config.populationSize);
+
+	size_t count = 0;
+	cacheHits = 0;
+	cacheMisses = 0;
+
+	for (size_t i = 0; i < config.populationSize; i++) {
+		if (!dirty[i])
+			continue; // гены не менялись с прошлой оценки
+
+		double score;
+
+		if (cache.Find(&genes[i * dimensions], score)) {
+			scores[i] = score;
+			dirty[i] = false;
+			cacheHits++;
+			continue;
+		}
+
+		if (cache.IsEnabled())
+			cacheMisses++;
+
+		pending[count++] = i;
+	}
+
+	// шаги декодирования считаются один раз на оценку, а не для каждой особи
+	for (size_t i = 0; i < dimensions; i++) {
+		lefts[i] = config.leftBorders[i];
+		steps[i] = GetDecodeStep<Bits>(config.leftBorders[i], config.rightBorders[i]);
+	}
+
+	evaluations = count;
+	return count;
+}
+
+// запуск обработки отобранных особей, параллельно при достаточном их количестве
+template <unsigned Bits, typename Operators>
+template <typename Task>
+void Population<Bits, Operators>::ForPending(const Config &config, size_t count, const Task &task) {
+	// для маленьких популяций передача работы потокам дороже самой оценки
+	if (!pool || count < config.parallelThreshold) {
+		task(0, count);
+		return;
+	}
+
+	// каждая особь оценивается независимо, поэтому результат совпадает с последовательным
+	pool->ParallelFor(count, task);
+}
+
+// сохранение новых оценок в кэш и снятие флагов изменения
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::UpdateCache(size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		size_t index = pending[i];
+
+		scores[index] = values[i];
+		dirty[index] = false;
+		cache.Insert(&genes[index * dimensions], values[i]);
+	}
+}
+
+// оценка приспособленности особей: тип оценочной функции известен при компиляции, поэтому её вызов встраивается в цикл
+template <unsigned Bits, typename Operators>
+template <typename Fitness>
+void Population<Bits, Operators>::Eval(const Config &config, const Fitness &f) {
+	PROFILE_PHASE(statistics, Phase::Eval);
+	size_t count = CollectPending(config);
+	PROFILE_COUNT(statistics.fitnessCalls, count);
+
+	ForPending(config, count, [this, &config, &f](size_t begin, size_t end) {
+		Decode(config, begin, end);
+
+		for (size_t i = begin; i < end; i++)
+			values[i] = f(&xs[i * dimensions], dimensions);
+	});
+
+	UpdateCache(count);
+}
+
+// получение младшего слова гена
+template <unsigned Bits, typename Operators>
+int Population<Bits, Operators>::GetWord(size_t index) const {
+	return (int) genes[index].words[0];
+}
+
+// декодирование отобранных особей в точки пространства поиска одним проходом
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Decode(const Config&, size_t begin, size_t end) {
+	const size_t *p = pending.data();
+
+	// одномерный случай: гены до 31 бита помещаются в знаковое 32-битное целое и преобразуются векторно сразу для нескольких особей
+	if (dimensions == 1 && Bits <= 31) {
+		double a = lefts[0];
+		double step = steps[0];
+		size_t i = begin;
+
+#if defined(__AVX512F__)
+		__m512d va = _mm512_set1_pd(a);
+		__m512d vstep = _mm512_set1_pd(step);
+
+		for (; i + 8 <= end; i += 8) {
+			__m256i bits = _mm256_setr_epi32(GetWord(p[i]), GetWord(p[i + 1]), GetWord(p[i + 2]), GetWord(p[i + 3]), GetWord(p[i + 4]), GetWord(p[i + 5]), GetWord(p[i + 6]), GetWord(p[i + 7]));
+			_mm512_storeu_pd(&xs[i], _mm512_add_pd(va, _mm512_mul_pd(_mm512_maskz_cvtepi32_pd(0xFF, bits), vstep))); // форма с обнулением не читает неопределённый регистр
+		}
+#elif defined(__AVX__)
+		__m256d va = _mm256_set1_pd(a);
+		__m256d vstep = _mm256_set1_pd(step);
+
+		for (; i + 4 <= end; i += 4) {
+			__m128i bits = _mm_setr_epi32(GetWord(p[i]), GetWord(p[i + 1]), GetWord(p[i + 2]), GetWord(p[i + 3]));
+			_mm256_storeu_pd(&xs[i], _mm256_add_pd(va, _mm256_mul_pd(_mm256_cvtepi32_pd(bits), vstep)));
+		}
+#endif
+
+		for (; i < end; i++)
+			xs[i] = genes[p[i]].Decode(a, step);
+
+		return;
+	}
+
+	// многомерный случай: гены особи лежат подряд, поэтому преобразуются векторно по измерениям
+	for (size_t i = begin; i < end; i++) {
+		size_t offset = p[i] * dimensions;
+		double *x = &xs[i * dimensions];
+		size_t d = 0;
+
+		if (Bits <= 31 && Genome<Bits>::Words == 1) {
+#if defined(__AVX512F__)
+			for (; d + 8 <= dimensions; d += 8) {
+				__m512i words = _mm512_loadu_si512((const void *) &genes[offset + d]);
+#if defined(__AVX512DQ__)
+				__m512d value = _mm512_cvtepi64_pd(words); // слова меньше 2^31 преобразуются точно
+#else
+				__m512d value = _mm512_maskz_cvtepi32_pd(0xFF, _mm512_maskz_cvtepi64_epi32(0xFF, words)); // формы с обнулением не читают неопределённый регистр
+#endif
+				_mm512_storeu_pd(x + d, _mm512_add_pd(_mm512_loadu_pd(&lefts[d]), _mm512_mul_pd(value, _mm512_loadu_pd(&steps[d]))));
+			}
+#elif defined(__AVX2__)
+			for (; d + 4 <= dimensions; d += 4) {
+				__m256i words = _mm256_loadu_si256((const __m256i *) &genes[offset + d]);
+				__m128i low = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(words, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+				_mm256_storeu_pd(x + d, _mm256_add_pd(_mm256_loadu_pd(&lefts[d]), _mm256_mul_pd(_mm256_cvtepi32_pd(low), _mm256_loadu_pd(&steps[d]))));
+			}
+#endif
+		}
+
+		for (; d < dimensions; d++)
+			x[d] = genes[offset + d].Decode(lefts[d], steps[d]);
+	}
 }
 
-// упорядочивание по возрастанию приспособленности
-void Population::Sort(const Config &config) {
+// пакетная оценка приспособленности особей
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Eval(const Config &config, BatchFunction f) {
+	PROFILE_PHASE(statistics, Phase::Eval);
+	size_t count = CollectPending(config);
+	PROFILE_COUNT(statistics.fitnessCalls, count);
+
+	ForPending(config, count, [this, &config, f](size_t begin, size_t end) {
+		Decode(config, begin, end);
+		f(&xs[begin * dimensions], &values[begin], end - begin, dimensions); // один вызов на весь диапазон
+	});
+
+	UpdateCache(count);
+}
+
+// получение числа вызовов оценочной функции на последней оценке
+template <unsigned Bits, typename Operators>
+size_t Population<Bits, Operators>::GetEvaluations() const {
+	return evaluations;
+}
+
+// получение числа попаданий в кэш на последней оценке
+template <unsigned Bits, typename Operators>
+size_t Population<Bits, Operators>::GetCacheHits() const {
+	return cacheHits;
+}
+
+// получение числа промахов кэша на последней оценке
+template <unsigned Bits, typename Operators>
+size_t Population<Bits, Operators>::GetCacheMisses() const {
+	return cacheMisses;
+}
+
+// получение числа вызовов оценочной функции на последнем локальном поиске
+template <unsigned Bits, typename Operators>
+size_t Population<Bits, Operators>::GetLocalEvaluations() const {
+	return localEvaluations;
+}
+
+// получение показателей эпохи
+template <unsigned Bits, typename Operators>
+const EpochStatistics& Population<Bits, Operators>::GetStatistics() const {
+	return statistics;
+}
+
+// обнуление показателей эпохи
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::ResetStatistics() {
+	statistics.Reset();
+}
+
+// заполнение записи телеметрии по оценённой популяции
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::GetTelemetry(const Config &config, size_t epoch, bool snapshot, TelemetryRecord &record) const {
+	double best = scores[0];
+	double mean = 0;
+	double squares = 0;
+
 	for (size_t i = 0; i < config.populationSize; i++) {
-        for (size_t j = i; j > 0 && (entities[j - 1].GetScore() - entities[j].GetScore()) * config.scale < 0; j--) {
-            Entity tmp = entities[j];
-            entities[j] = entities[j - 1];
-            entities[j - 1] = tmp;
-        }
-    }
+		if ((scores[i] - best) * Operators::GetScale(config) > 0)
+			best = scores[i];
+
+		mean += scores[i];
+		squares += scores[i] * scores[i];
+	}
+
+	mean /= config.populationSize;
+
+	record.epoch = epoch;
+	record.best = best;
+	record.mean = mean;
+	record.deviation = sqrt(std::max(0.0, squares / config.populationSize - mean * mean));
+	record.evaluations = evaluations;
+
+	record.entities = snapshot ? config.populationSize : 0;
+	record.words = dimensions * Genome<Bits>::Words;
+
+	// записи буфера телеметрии заранее выделены под снимок всей популяции, поэтому гены копируются на место без выделения памяти
+	if (snapshot) {
+		const uint64_t *words = genes[0].words;
+		record.scores.assign(scores.begin(), scores.begin() + config.populationSize);
+		record.bits.assign(words, words + config.populationSize * record.words);
+	}
+}
+
+// расчёт разнообразия текущих генов за один проход
+template <unsigned Bits, typename Operators>
+const Diversity<Bits>& Population<Bits, Operators>::UpdateDiversity(const Config &config) {
+	diversity.Compute(genes.data(), config.populationSize);
+	return diversity;
+}
+
+// получение последнего рассчитанного разнообразия
+template <unsigned Bits, typename Operators>
+const Diversity<Bits>& Population<Bits, Operators>::GetDiversity() const {
+	return diversity;
+}
+
+// сохранение снимка популяции
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::SaveCheckpoint(const std::string &path, const Config &config, const CheckpointState &state) const {
+	uint64_t randomState[4];
+	random.GetState(randomState);
+
+	// состояние, не входящее в особей: списки особей, на которых завершился локальный поиск, и кэш оценок
+	std::vector<char> extra;
+	BinaryWriter writer(extra);
+	writer.Write((uint64_t) optima.size());
+	writer.WriteBytes(optima.data(), optima.size() * sizeof(Genome<Bits>));
+	writer.Write((uint64_t) previousOptima.size());
+	writer.WriteBytes(previousOptima.data(), previousOptima.size() * sizeof(Genome<Bits>));
+	cache.Save(writer);
+
+	WriteCheckpoint(path, config, state, Bits, randomState, genes.data(), config.populationSize * dimensions * sizeof(Genome<Bits>), scores.data(), dirty, extra);
+}
+
+// восстановление популяции из снимка: гены и оценки копируются из отображённого файла без разбора
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::LoadCheckpoint(const Config &config, const Checkpoint &checkpoint) {
+	size_t genesSize = config.populationSize * dimensions * sizeof(Genome<Bits>);
+
+	if (checkpoint.GetBits() != Bits || checkpoint.GetEntities() != config.populationSize || checkpoint.GetDimensions() != dimensions || checkpoint.GetGenesSize() < genesSize)
+		throw std::runtime_error("checkpoint does not match the population");
+
+	memcpy(genes.data(), checkpoint.GetGenes(), genesSize);
+	memcpy(scores.data(), checkpoint.GetScores(), config.populationSize * sizeof(double));
+
+	const uint8_t *flags = checkpoint.GetDirty();
+
+	for (size_t i = 0; i < config.populationSize; i++)
+		dirty[i] = flags[i] != 0;
+
+	uint64_t randomState[4];
+	checkpoint.GetRandom(randomState);
+	random.SetState(randomState); // продолжаем ту же последовательность случайных чисел
+
+	BinaryReader reader = checkpoint.GetExtra();
+	std::vector<Genome<Bits>> *lists[2] = { &optima, &previousOptima };
+
+	for (int i = 0; i < 2; i++) {
+		uint64_t count;
+		reader.Read(count);
+
+		if (count % dimensions != 0 || count * sizeof(Genome<Bits>) > reader.GetRemaining())
+			throw std::runtime_error("checkpoint does not match the population");
+
+		lists[i]->resize(count);
+		reader.ReadBytes(lists[i]->data(), count * sizeof(Genome<Bits>));
+	}
+
+	cache.Load(reader);
+}
+
+// лучше ли особь i особи j (при равенстве впереди особь с меньшим индексом)
+template <unsigned Bits, typename Operators>
+bool Population<Bits, Operators>::IsBetter(const Config &config, size_t i, size_t j) const {
+	double delta = (scores[i] - scores[j]) * Operators::GetScale(config);
+	return delta > 0 || (delta == 0 && i < j);
+}
+
+// отбор индексов k лучших особей: первые k элементов order упорядочены от лучшей к худшей
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::SelectBest(const Config &config, size_t k) {
+	auto better = [this, &config](size_t i, size_t j) {
+		return IsBetter(config, i, j);
+	};
+
+	Reserve(order, config.populationSize);
+
+	for (size_t i = 0; i < config.populationSize; i++)
+		order[i] = i;
+
+	// особи не перемещаются, упорядочиваются только их индексы
+	if (k < config.populationSize)
+		std::nth_element(order.begin(), order.begin() + k, order.begin() + config.populationSize, better);
+
+	std::sort(order.begin(), order.begin() + std::min(k, config.populationSize), better);
+}
+
+// упорядочивание по убыванию приспособленности
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Sort(const Config &config) {
+	SelectBest(config, config.populationSize);
+
+	for (size_t i = 0; i < config.populationSize; i++)
+		Copy(order[i], i);
+
+	SwapBuffers(); // буферы меняются ролями без копирования
 }
 
 // получение самой приспособленной особи
-Entity Population::GetBestEntity(const Config& config) const {
+template <unsigned Bits, typename Operators>
+Entity<Bits> Population<Bits, Operators>::GetBestEntity(const Config& config) const {
+	Entity<Bits> entity;
+	GetBestEntity(config, entity);
+	return entity;
+}
+
+// копирование самой приспособленной особи в entity: после первого вызова память генов не выделяется
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::GetBestEntity(const Config& config, Entity<Bits> &entity) const {
 	size_t best = 0;
 
 	// ищем среди всех особей самую приспособленную
 	for (size_t i = 1; i < config.populationSize; i++)
-		if ((entities[i].GetScore() - entities[best].GetScore()) * config.scale > 0)
+		if ((scores[i] - scores[best]) * Operators::GetScale(config) > 0)
 			best = i;
 
-	return entities[best]; // возвращаем самую приспособленную особь
+	entity.Assign(&genes[best * dimensions], dimensions, scores[best]);
 }
 
-// сохранение лучших особей
-void Population::PreserveBestEntities(const Config& config) {
-	// перемещаем в начало лучшие позиции
-	for (size_t i = 0; i < config.preservedPositions; i++) {
-		double bestScore = entities[i].GetScore();
-		size_t bestIndex = i;
+// получение count лучших особей (от лучшей к худшей)
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::GetBestEntities(const Config &config, size_t count, std::vector<Entity<Bits>> &entities) {
+	count = std::min(count, config.populationSize);
+	SelectBest(config, count);
+	entities.resize(count);
 
-		for (size_t j = i + 1; j < config.populationSize; j++) {
-			double score = entities[j].GetScore();
+	for (size_t i = 0; i < count; i++)
+		entities[i] = Entity<Bits>(&genes[order[i] * dimensions], dimensions, scores[order[i]]);
+}
 
-			if ((score - bestScore) * config.scale > 0) {
-				bestScore = score;
-				bestIndex = j;
-			}
-		}
+// передача генов и оценок count лучших особей (от лучшей к худшей): sink(genes, score) вызывается для каждой особи
+template <unsigned Bits, typename Operators>
+template <typename Sink>
+void Population<Bits, Operators>::ForBestEntities(const Config &config, size_t count, const Sink &sink) {
+	count = std::min(count, config.populationSize);
+	SelectBest(config, count);
 
-		// переставляем очередную лучшую особь в начало
-		Entity tmp = entities[i];
-		entities[i] = entities[bestIndex];
-		entities[bestIndex] = tmp;
-	}
+	for (size_t i = 0; i < count; i++)
+		sink(&genes[order[i] * dimensions], scores[order[i]]);
+}
+
+// замена худшей особи оценённой особью извне
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Immigrate(const Config &config, const Entity<Bits> &entity) {
+	Immigrate(config, entity.GetGenes(), entity.GetScore());
+}
+
+// замена худшей особи оценённой особью извне по генам и оценке
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Immigrate(const Config &config, const Genome<Bits> *entity, double score) {
+	size_t worst = 0;
+
+	for (size_t i = 1; i < config.populationSize; i++)
+		if ((scores[worst] - scores[i]) * Operators::GetScale(config) > 0)
+			worst = i;
+
+	std::copy(entity, entity + dimensions, genes.begin() + worst * dimensions);
+	scores[worst] = score;
+	dirty[worst] = false; // оценка пришла вместе с особью
+}
+
+// сохранение лучших особей: их индексы занимают начало массива родителей
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::PreserveBestEntities(const Config& config) {
+	SelectBest(config, config.preservedPositions);
+
+	for (size_t i = 0; i < config.preservedPositions; i++)
+		parents[i] = order[i];
 }
 
 // расчёт фитнес функции в зависимости от оценочной функции
-std::vector<double> Population::GetFitness(const Config& config) {
-	std::vector<double> fitness(config.populationSize);
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::GetFitness(const Config& config) {
+	Reserve(fitness, config.populationSize);
 
-	double minScore = entities[0].GetScore();
-	double maxScore = entities[0].GetScore();
+	double minScore = scores[0];
+	double maxScore = scores[0];
 
 	// считаем минимальное и максимальное значение оценочной функции
 	for (size_t i = 1; i < config.populationSize; i++) {
-		double score = entities[i].GetScore();
+		double score = scores[i];
 
 		if (score > maxScore)
 			maxScore = score;
@@ -109,138 +646,396 @@ std::vector<double> Population::GetFitness(const Config& config) {
 			minScore = score;
 	}
 
-	// заполняем значение фитнесс функции
-	for (size_t i = 0; i < config.populationSize; i++) {
-		if (config.mode == "max") {
-			fitness[i] = (entities[i].GetScore() - minScore) / (maxScore - minScore);
-		}
-		else {
-			fitness[i] = (maxScore - entities[i].GetScore()) / (maxScore - minScore);
-		}
+	// все особи одинаковы - равные доли рулетки
+	if (maxScore == minScore) {
+		for (size_t i = 0; i < config.populationSize; i++)
+			fitness[i] = 1;
+
+		return;
 	}
 
-	return fitness;
+	// заполняем значение фитнесс функции, направление проверяется один раз, а не для каждой особи
+	if (Operators::GetScale(config) > 0) {
+		for (size_t i = 0; i < config.populationSize; i++)
+			fitness[i] = (scores[i] - minScore) / (maxScore - minScore);
+	}
+	else {
+		for (size_t i = 0; i < config.populationSize; i++)
+			fitness[i] = (maxScore - scores[i]) / (maxScore - minScore);
+	}
 }
 
 // случайный отбор
-std::vector<Entity> Population::RandomSelection(const Config& config) {
-	std::vector<Entity> parents;
-
-	for (size_t i = config.preservedPositions; i < config.selectionSize; i++) {
-		size_t index = GetRandom(config.populationSize);
-		parents.push_back(entities[index]);
-	}
-
-	return parents;
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::RandomSelection(const Config& config) {
+	for (size_t i = config.preservedPositions; i < config.selectionSize; i++)
+		parents[i] = random.GetInt(config.populationSize);
 }
 
 // отбор турниром
-std::vector<Entity> Population::TournamentSelection(const Config& config) {
-	std::vector<Entity> parents;
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::TournamentSelection(const Config& config) {
+	size_t count = config.selectionSize - config.preservedPositions;
+	size_t k = config.tournamentSize;
+	Reserve(indices, count * k);
 
-	for (size_t i = config.preservedPositions; i < config.selectionSize; i++) {
-		size_t index1 = GetRandom(config.populationSize);
-		size_t index2 = GetRandom(config.populationSize);
+	// разыгрываем участников всех турниров одним проходом
+	for (size_t i = 0; i < count * k; i++)
+		indices[i] = random.GetInt(config.populationSize);
 
-		double score1 = entities[index1].GetScore();
-		double score2 = entities[index2].GetScore();
+	for (size_t i = 0; i < count; i++) {
+		size_t best = indices[i * k];
 
-		if ((score1 - score2) * config.scale > 0) {
-			parents.push_back(entities[index1]);
-		}
-		else {
-			parents.push_back(entities[index2]);
+		// при равенстве побеждает более поздний участник
+		for (size_t j = 1; j < k; j++) {
+			size_t index = indices[i * k + j];
+
+			if ((scores[index] - scores[best]) * Operators::GetScale(config) >= 0)
+				best = index;
 		}
-	}
 
-	return parents;
+		parents[config.preservedPositions + i] = best;
+	}
 }
 
 // отбор рулеткой
-std::vector<Entity> Population::RoulleteSelection(const Config& config) {
-	std::vector<double> fitness = GetFitness(config);
-	double sum = 0;
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::RoulleteSelection(const Config& config) {
+	GetFitness(config);
 
-	// считаем нормализованную сумму оценки приспособленности
-	for (size_t i = 0; i < config.populationSize; i++)
-		sum += fitness[i];
-	
-	std::vector<Entity> parents;
+	// строим префиксные суммы приспособленности один раз за поколение
+	for (size_t i = 1; i < config.populationSize; i++)
+		fitness[i] += fitness[i - 1];
 
-	// отбираем подходящие особи
+	double sum = fitness[config.populationSize - 1];
+
+	// отбираем подходящие особи двоичным поиском сектора рулетки
 	for (size_t i = config.preservedPositions; i < config.selectionSize; i++) {
-		double rnd = GetRandom();
-		double pi = 0;
-		size_t j = 0;
+		double rnd = random.GetReal() * sum;
+		size_t j = std::upper_bound(fitness.begin(), fitness.begin() + config.populationSize, rnd) - fitness.begin();
 
-		while (pi > rnd || rnd > pi + fitness[j] / sum) {
-			pi += fitness[j] / sum;
-			j++;
-		}
+		if (j == config.populationSize)
+			j--;
 
-		parents.push_back(entities[j]);
+		parents[i] = j;
 	}
-
-	return parents;
 }
 
 // отбор усечением
-std::vector<Entity> Population::CutSelection(const Config& config) {
-	Sort(config);
-	std::vector<Entity> parents;
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::CutSelection(const Config& config) {
+	SelectBest(config, config.selectionSize); // полная сортировка не нужна, достаточно лучших
 
 	for (size_t i = config.preservedPositions; i < config.selectionSize; i++)
-		parents.push_back(entities[i]);
+		parents[i] = order[i];
+}
+
+// расчёт интенсивности отбора: (средняя оценка родителей - средняя оценка популяции) / стандартное отклонение
+template <unsigned Bits, typename Operators>
+double Population<Bits, Operators>::GetSelectionPressure(const Config &config) const {
+	double mean = 0;
+	double squares = 0;
+	double selected = 0;
+
+	for (size_t i = 0; i < config.populationSize; i++) {
+		mean += scores[i];
+		squares += scores[i] * scores[i];
+	}
+
+	for (size_t i = 0; i < config.selectionSize; i++)
+		selected += scores[parents[i]];
+
+	mean /= config.populationSize;
+	selected /= config.selectionSize;
+
+	double variance = squares / config.populationSize - mean * mean;
+
+	if (variance <= 0)
+		return 0; // все особи одинаковы, отбор ничего не меняет
+
+	return (selected - mean) * Operators::GetScale(config) / sqrt(variance);
+}
+
+// подсчёт потомков, совпавших с одним из родителей
+template <unsigned Bits, typename Operators>
+size_t Population<Bits, Operators>::CountDuplicates(size_t offset, size_t count) const {
+	size_t duplicates = 0;
 
-	return parents;
+	for (size_t i = 0; i < count; i++) {
+		const Genome<Bits> *child = &nextGenes[(offset + i) * dimensions];
+
+		if (std::equal(child, child + dimensions, &genes[first[i] * dimensions]) || std::equal(child, child + dimensions, &genes[second[i] * dimensions]))
+			duplicates++;
+	}
+
+	return duplicates;
 }
 
-// отбор
-void Population::Selection(const Config& config) {
+// отбор: заполняет индексы родителей следующего поколения
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Selection(const Config& config) {
+	PROFILE_PHASE(statistics, Phase::Selection);
+	Reserve(parents, config.selectionSize);
 	PreserveBestEntities(config); // защищаем лучшие особи
-	std::vector<Entity> parents;
 
-	if (config.selectionType == SelectionType::Random) {
-		parents = RandomSelection(config);
+	SelectionType type = Operators::GetSelection(config); // при известных при компиляции операторах - константа
+
+	if (type == SelectionType::Random) {
+		RandomSelection(config);
 	}
-	else if (config.selectionType == SelectionType::Tournament) {
-		parents = TournamentSelection(config);
+	else if (type == SelectionType::Tournament) {
+		TournamentSelection(config);
 	}
-	else if (config.selectionType == SelectionType::Roullete) {
-		parents = RoulleteSelection(config);
+	else if (type == SelectionType::Roullete) {
+		RoulleteSelection(config);
 	}
-	else if (config.selectionType == SelectionType::Cut) {
-		parents = CutSelection(config);
+	else if (type == SelectionType::Cut) {
+		CutSelection(config);
 	} else {
 		throw std::runtime_error("unhandled SelectionType");
 	}
 
-	// копируем выбранные особи после защищённых
-	for (size_t i = config.preservedPositions; i < config.selectionSize; i++)
-		entities[i] = parents[i - config.preservedPositions];
+	PROFILE_SET(statistics.selectionPressure, GetSelectionPressure(config));
 }
 
-// скрещивание
-void Population::Crossbreeding(const Config &config) {
-	for (size_t i = config.selectionSize; i < config.populationSize; i++) {
-		int parent1 = GetRandom(config.selectionSize); // выбираем первого родителя
-		int parent2 = GetRandom(config.selectionSize); // выбираем второго родителя
+// скрещивание: строит следующее поколение во втором буфере
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Crossbreeding(const Config &config) {
+	PROFILE_PHASE(statistics, Phase::Crossbreeding);
+	Reserve(nextGenes, config.populationSize * dimensions);
+	Reserve(nextScores, config.populationSize);
+	Reserve(nextDirty, config.populationSize);
+
+	// защищённые и отобранные особи переходят без изменений
+	for (size_t i = 0; i < config.selectionSize; i++)
+		Copy(parents[i], i);
 
-		entities[i] = Crossbreed(entities[parent1], entities[parent2], config.crossbreedingType); // выполняем скрещивание
+	size_t count = config.populationSize - config.selectionSize;
+	Reserve(first, count);
+	Reserve(second, count);
+	Reserve(draws, 2 * count);
+
+	for (size_t i = 0; i < count; i++) {
+		first[i] = parents[random.GetInt(config.selectionSize)]; // выбираем первого родителя
+		second[i] = parents[random.GetInt(config.selectionSize)]; // выбираем второго родителя
 	}
+
+	// скрещиваем всех потомков одним вызовом выбранного ядра, потомки записываются сразу на свои места
+	Crossbreed(genes.data(), first.data(), second.data(), &nextGenes[config.selectionSize * dimensions], count, dimensions, Operators::GetCrossbreeding(config), random, draws.data());
+
+	for (size_t i = config.selectionSize; i < config.populationSize; i++)
+		nextDirty[i] = true;
+
+	PROFILE_COUNT(statistics.crossovers, count);
+	PROFILE_COUNT(statistics.duplicates, CountDuplicates(config.selectionSize, count));
+
+	SwapBuffers(); // буферы меняются ролями без копирования
 }
 
-// мутация
-void Population::Mutation(const Config &config) {
-	for (size_t i = config.preservedPositions; i < config.populationSize; i++) // мутируют только незащищённые особи
-		if (GetRandom() < config.mutationProbability)
-			Mutate(entities[i], config.mutationType); // выполняем мутацию
+// мутация особей видом, известным при компиляции
+template <unsigned Bits, typename Operators>
+template <MutationType Type>
+void Population<Bits, Operators>::Mutation(const Config &config) {
+	for (size_t i = config.preservedPositions; i < config.populationSize; i++) { // мутируют только незащищённые особи
+		if (random.GetReal() < config.mutationProbability) {
+			Mutate<Type>(&genes[i * dimensions], dimensions, random); // выполняем мутацию без выбора вида на каждой особи
+			dirty[i] = true;
+			PROFILE_COUNT(statistics.mutations, 1);
+		}
+	}
+}
+
+// мутация: вид выбирается один раз на поколение
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Mutation(const Config &config) {
+	PROFILE_PHASE(statistics, Phase::Mutation);
+	MutationType type = Operators::GetMutation(config);
+
+	if (type == MutationType::Random) {
+		Mutation<MutationType::Random>(config);
+	}
+	else if (type == MutationType::Swap) {
+		Mutation<MutationType::Swap>(config);
+	}
+	else if (type == MutationType::Reverse) {
+		Mutation<MutationType::Reverse>(config);
+	}
+	else
+		throw std::runtime_error("unhandled MutationType");
+}
+
+// замена незащищённых особей случайными: после скрещивания защищённые особи занимают начало популяции
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Reseed(const Config &config) {
+	for (size_t i = config.preservedPositions; i < config.populationSize; i++) {
+		for (size_t j = 0; j < dimensions; j++)
+			genes[i * dimensions + j] = Genome<Bits>::GetRandom(random);
+
+		dirty[i] = true;
+	}
+}
+
+// завершался ли локальный поиск на особи с такими генами на текущей или предыдущей эпохе
+template <unsigned Bits, typename Operators>
+bool Population<Bits, Operators>::IsClimbed(const Genome<Bits> *entity) const {
+	for (size_t i = 0; i < optima.size(); i += dimensions)
+		if (std::equal(entity, entity + dimensions, optima.begin() + i))
+			return true;
+
+	for (size_t i = 0; i < previousOptima.size(); i += dimensions)
+		if (std::equal(entity, entity + dimensions, previousOptima.begin() + i))
+			return true;
+
+	return false;
+}
+
+// локальный поиск по битам у лучших защищённых особей: для каждого бита от старшего к младшему одним пакетом оцениваются все соседи особи,
+// отличающиеся инверсией этого бита в одном из генов, и лучший из них замещает особь, если он лучше неё. Проходы по битам повторяются, пока
+// они улучшают особь и не исчерпан бюджет эпохи. Особи, на которых поиск уже завершился, повторно не улучшаются
+template <unsigned Bits, typename Operators>
+template <typename Evaluate>
+void Population<Bits, Operators>::Climb(const Config &config, const Evaluate &evaluate) {
+	PROFILE_PHASE(statistics, Phase::Eval);
+	size_t elites = std::min(config.memeticElites, config.preservedPositions);
+	size_t capacity = std::min(dimensions, config.memeticBudget); // соседей по одному биту не больше, чем генов
+
+	localEvaluations = 0;
+	previousOptima.swap(optima);
+	optima.clear();
+
+	// у каждой особи временно запоминаются исходные гены и найденный оптимум; списки меняются местами каждую эпоху,
+	// поэтому память резервируется под оба сразу и в последующих эпохах не выделяется
+	optima.reserve(2 * elites * dimensions);
+	previousOptima.reserve(2 * elites * dimensions);
+
+	Reserve(flips, capacity);
+	Reserve(point, dimensions);
+	Reserve(xs, capacity * dimensions);
+	Reserve(values, capacity);
+
+	for (size_t i = 0; i < dimensions; i++) {
+		lefts[i] = config.leftBorders[i];
+		steps[i] = GetDecodeStep<Bits>(config.leftBorders[i], config.rightBorders[i]);
+	}
+
+	for (size_t e = 0; e < elites && localEvaluations < config.memeticBudget; e++) {
+		size_t index = parents[e];
+		Genome<Bits> *entity = &genes[index * dimensions];
+
+		if (IsClimbed(entity))
+			continue;
+
+		// особи достаётся равная доля оставшегося бюджета, неизрасходованная часть переходит следующим
+		size_t limit = localEvaluations + (config.memeticBudget - localEvaluations) / (elites - e);
+		size_t start = optima.size();
+		bool improved = true;
+		bool complete = false;
+
+		optima.insert(optima.end(), entity, entity + dimensions);
+
+		for (size_t i = 0; i < dimensions; i++)
+			point[i] = entity[i].Decode(lefts[i], steps[i]);
+
+		while (improved && localEvaluations < limit) {
+			improved = false;
+			complete = true;
+
+			for (unsigned bit = Bits; bit-- > 0 && complete; ) {
+				size_t count = 0;
+				size_t best = dimensions;
+				double bestScore = scores[index];
+
+				// соседи из кэша не тратят бюджет, остальные собираются в пакет
+				for (size_t d = 0; d < dimensions; d++) {
+					double score;
+					entity[d].InverseBit(bit);
+
+					if (cache.Find(entity, score)) {
+						if ((score - bestScore) * Operators::GetScale(config) > 0) {
+							best = d;
+							bestScore = score;
+						}
+					}
+					else if (localEvaluations + count < limit) {
+						double *x = &xs[count * dimensions];
+						std::copy(point.begin(), point.begin() + dimensions, x);
+						x[d] = entity[d].Decode(lefts[d], steps[d]);
+						flips[count++] = d;
+					}
+					else {
+						complete = false; // бюджет исчерпан, не все соседи проверены
+					}
+
+					entity[d].InverseBit(bit);
+				}
+
+				evaluate(count);
+				localEvaluations += count;
+				PROFILE_COUNT(statistics.fitnessCalls, count);
+
+				for (size_t i = 0; i < count; i++) {
+					size_t d = flips[i];
+
+					entity[d].InverseBit(bit);
+					cache.Insert(entity, values[i]);
+					entity[d].InverseBit(bit);
+
+					if ((values[i] - bestScore) * Operators::GetScale(config) > 0) {
+						best = d;
+						bestScore = values[i];
+					}
+				}
+
+				if (best < dimensions) {
+					entity[best].InverseBit(bit);
+					point[best] = entity[best].Decode(lefts[best], steps[best]);
+					scores[index] = bestScore;
+					improved = true;
+				}
+			}
+		}
+
+		// поиск прерван бюджетом - на следующей эпохе особь улучшается дальше
+		if (!complete || improved) {
+			optima.resize(start);
+			continue;
+		}
+
+		if (!std::equal(entity, entity + dimensions, optima.begin() + start))
+			optima.insert(optima.end(), entity, entity + dimensions);
+	}
+}
+
+// локальный поиск у лучших защищённых особей функцией, функтором или лямбдой от точки
+template <unsigned Bits, typename Operators>
+template <typename Fitness>
+void Population<Bits, Operators>::Refine(const Config &config, const Fitness &f) {
+	Climb(config, [this, &config, &f](size_t count) {
+		ForPending(config, count, [this, &f](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+				values[i] = f(&xs[i * dimensions], dimensions);
+		});
+	});
+}
+
+// локальный поиск у лучших защищённых особей пакетной функцией
+template <unsigned Bits, typename Operators>
+void Population<Bits, Operators>::Refine(const Config &config, BatchFunction f) {
+	Climb(config, [this, &config, f](size_t count) {
+		ForPending(config, count, [this, f](size_t begin, size_t end) {
+			f(&xs[begin * dimensions], &values[begin], end - begin, dimensions);
+		});
+	});
 }
 
 // вывод популяции
-std::ostream& operator<<(std::ostream& os, const Population& population) {
-	for (size_t i = 0; i < population.entities.size(); i++)
-		os << (i + 1) << ". " << population.entities[i] << std::endl;
+template <unsigned Bits, typename Operators>
+std::ostream& operator<<(std::ostream& os, const Population<Bits, Operators>& population) {
+	for (size_t i = 0; i < population.scores.size(); i++) {
+		os << (i + 1) << ". entity: " << population.scores[i] << ", bits: [";
+		PrintGenes(os, &population.genes[i * population.dimensions], population.dimensions);
+		os << "]\n"; // без сброса буфера на каждой особи
+	}
 
 	return os;
-}
\ No newline at end of file
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <iostream>
+#include <chrono>
+
+// фазы эпохи
+enum class Phase {
+	Eval, // оценка
+	Selection, // отбор
+	Crossbreeding, // скрещивание
+	Mutation // мутация
+};
+
+const int PHASES = 4; // число фаз эпохи
+
+// показатели одной эпохи (заполняются только при сборке с GENETIC_PROFILE)
+struct EpochStatistics {
+	double times[PHASES]; // время фаз в секундах
+	size_t fitnessCalls; // число вызовов оценочной функции
+	size_t mutations; // число выполненных мутаций
+	size_t crossovers; // число выполненных скрещиваний
+	size_t duplicates; // число потомков, совпавших с одним из родителей
+	double selectionPressure; // интенсивность отбора: отклонение средней оценки родителей от средней по популяции в единицах стандартного отклонения
+
+	EpochStatistics(); // создание обнулённых показателей
+	void Reset(); // обнуление показателей
+};
+
+// таймер, добавляющий время жизни области видимости к заданному значению
+class ScopedTimer {
+	double &seconds; // накапливаемое время
+	std::chrono::steady_clock::time_point start; // момент создания
+public:
+	ScopedTimer(double &seconds);
+	~ScopedTimer();
+};
+
+// при выключенном профилировании макросы не порождают никакого кода
+#if defined(GENETIC_PROFILE)
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_PHASE(statistics, phase) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)((statistics).times[(int) (phase)])
+#define PROFILE_COUNT(counter, value) ((counter) += (value))
+#define PROFILE_SET(variable, value) ((variable) = (value))
+#else
+#define PROFILE_PHASE(statistics, phase)
+#define PROFILE_COUNT(counter, value)
+#define PROFILE_SET(variable, value)
+#endif
+
+// создание обнулённых показателей
+EpochStatistics::EpochStatistics() {
+	Reset();
+}
+
+// обнуление показателей
+void EpochStatistics::Reset() {
+	for (int i = 0; i < PHASES; i++)
+		times[i] = 0;
+
+	fitnessCalls = 0;
+	mutations = 0;
+	crossovers = 0;
+	duplicates = 0;
+	selectionPressure = 0;
+}
+
+ScopedTimer::ScopedTimer(double &seconds) : seconds(seconds) {
+	start = std::chrono::steady_clock::now();
+}
+
+ScopedTimer::~ScopedTimer() {
+	seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// вывод показателей эпохи
+std::ostream& operator<<(std::ostream& os, const EpochStatistics& statistics) {
+	os << "eval: " << statistics.times[(int) Phase::Eval] * 1e6 << " us";
+	os << ", selection: " << statistics.times[(int) Phase::Selection] * 1e6 << " us";
+	os << ", crossbreeding: " << statistics.times[(int) Phase::Crossbreeding] * 1e6 << " us";
+	os << ", mutation: " << statistics.times[(int) Phase::Mutation] * 1e6 << " us";
+	os << ", fitness calls: " << statistics.fitnessCalls;
+	os << ", crossovers: " << statistics.crossovers;
+	os << ", duplicates: " << statistics.duplicates;
+	os << ", mutations: " << statistics.mutations;
+	os << ", selection pressure: " << statistics.selectionPressure;
+	return os;
+}
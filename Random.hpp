@@ -0,0 +1,122 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+
+// генератор псевдослучайных чисел xoshiro256**
+class Random {
+	uint64_t state[4]; // состояние генератора
+
+	static uint64_t Rotate(uint64_t x, int k); // циклический сдвиг влево
+	static uint64_t SplitMix(uint64_t &x); // генератор для инициализации состояния
+public:
+	Random(uint64_t seed = 0, size_t stream = 0); // создание генератора для заданного потока
+
+	uint64_t Next(); // получение очередного 64-битного числа
+	void Jump(); // переход на 2^128 чисел вперёд (к следующему независимому потоку)
+
+	void GetState(uint64_t state[4]) const; // получение состояния генератора
+	void SetState(const uint64_t state[4]); // восстановление состояния генератора
+
+	double GetReal(); // получение вещественного числа из [0, 1)
+	unsigned GetInt(unsigned maxValue); // получение целого числа из [0, maxValue)
+	unsigned GetInt(unsigned minValue, unsigned maxValue); // получение целого числа из [minValue, maxValue)
+};
+
+// создание генератора для заданного потока
+Random::Random(uint64_t seed, size_t stream) {
+	for (int i = 0; i < 4; i++)
+		state[i] = SplitMix(seed);
+
+	// потоки с разными номерами не пересекаются на 2^128 чисел
+	for (size_t i = 0; i < stream; i++)
+		Jump();
+}
+
+// циклический сдвиг влево
+uint64_t Random::Rotate(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+// генератор для инициализации состояния
+uint64_t Random::SplitMix(uint64_t &x) {
+	uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// получение очередного 64-битного числа
+uint64_t Random::Next() {
+	uint64_t result = Rotate(state[1] * 5, 7) * 9;
+	uint64_t t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = Rotate(state[3], 45);
+
+	return result;
+}
+
+// переход на 2^128 чисел вперёд (к следующему независимому потоку)
+void Random::Jump() {
+	static const uint64_t jump[] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+	uint64_t s[4] = { 0, 0, 0, 0 };
+
+	for (int i = 0; i < 4; i++) {
+		for (int b = 0; b < 64; b++) {
+			if (jump[i] & (1ULL << b)) {
+				for (int j = 0; j < 4; j++)
+					s[j] ^= state[j];
+			}
+
+			Next();
+		}
+	}
+
+	for (int j = 0; j < 4; j++)
+		state[j] = s[j];
+}
+
+// получение состояния генератора
+void Random::GetState(uint64_t state[4]) const {
+	for (int i = 0; i < 4; i++)
+		state[i] = this->state[i];
+}
+
+// восстановление состояния генератора
+void Random::SetState(const uint64_t state[4]) {
+	for (int i = 0; i < 4; i++)
+		this->state[i] = state[i];
+}
+
+// получение вещественного числа из [0, 1)
+double Random::GetReal() {
+	return (Next() >> 11) * (1.0 / 9007199254740992.0); // старшие 53 бита, делённые на 2^53
+}
+
+// получение целого числа из [0, maxValue) без смещения (метод Лемира)
+unsigned Random::GetInt(unsigned maxValue) {
+	uint64_t product = (Next() >> 32) * maxValue;
+	uint32_t low = (uint32_t) product;
+
+	// отбрасываем значения, дающие смещение (деление выполняется крайне редко)
+	if (low < maxValue) {
+		uint32_t threshold = (uint32_t) -maxValue % maxValue;
+
+		while (low < threshold) {
+			product = (Next() >> 32) * maxValue;
+			low = (uint32_t) product;
+		}
+	}
+
+	return product >> 32;
+}
+
+// получение целого числа из [minValue, maxValue)
+unsigned Random::GetInt(unsigned minValue, unsigned maxValue) {
+	return minValue + GetInt(maxValue - minValue);
+}
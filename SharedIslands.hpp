@@ -0,0 +1,543 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <string>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#endif
+
+#include "Config.hpp"
+#include "Population.hpp"
+#include "Islands.hpp"
+
+// состояние острова в разделяемой памяти (занимает отдельную кэш-линию)
+struct SharedIslandState {
+	std::atomic<uint64_t> epoch; // число выполненных эпох
+	std::atomic<double> best; // лучшее значение острова
+	std::atomic<uint64_t> sent; // число отправленных мигрантов
+	std::atomic<uint64_t> received; // число принятых мигрантов
+	std::atomic<uint64_t> dropped; // число отброшенных мигрантов
+	std::atomic<uint32_t> finished; // завершился ли остров
+	char padding[20];
+};
+
+// заголовок кольцевого буфера мигрантов в разделяемой памяти
+struct SharedRingHeader {
+	std::atomic<uint64_t> head; // номер следующей читаемой записи (меняет только читатель)
+	char headPadding[56]; // счётчики читателя и писателя лежат в разных кэш-линиях
+	std::atomic<uint64_t> tail; // номер следующей записываемой записи (меняет только писатель)
+	char tailPadding[56];
+};
+
+// модель островов в отдельных процессах, обменивающихся мигрантами через разделяемую память POSIX
+template <unsigned Bits>
+class ProcessIslandModel {
+	std::vector<Config> configs; // конфигурации островов
+	size_t islands; // число островов
+	size_t dimensions; // число генов особи
+	int scale; // множитель для сравнений
+
+	size_t recordSize; // размер упакованной записи особи: оценка и гены
+	size_t capacity; // число записей в кольцевом буфере (степень двойки)
+	size_t ringSize; // размер кольцевого буфера вместе с заголовком
+
+	char *memory; // отображённая разделяемая память
+	size_t memorySize; // размер разделяемой памяти
+	std::vector<int> pids; // идентификаторы процессов островов
+	std::vector<int> statuses; // коды завершения процессов островов, полученные waitpid
+	std::vector<bool> reaped; // получен ли код завершения процесса острова
+	std::vector<IslandResult<Bits>> results; // итоги островов
+
+	static size_t Align(size_t size); // выравнивание размера на кэш-линию
+
+	std::atomic<uint32_t>& GetStop(); // флаг остановки всех островов
+	SharedIslandState& GetState(size_t island); // состояние острова
+	char* GetResult(size_t island); // запись с лучшей особью острова
+	SharedRingHeader& GetRing(size_t from, size_t to); // кольцевой буфер от острова from к острову to
+	char* GetRecord(size_t from, size_t to, uint64_t index); // запись кольцевого буфера
+
+	void Pack(const Genome<Bits> *genes, double score, char *record) const; // упаковка генов и оценки в запись
+	void Pack(const Entity<Bits> &entity, char *record) const; // упаковка особи в запись
+	double Unpack(const char *record, Genome<Bits> *genes) const; // распаковка генов записи в буфер, возвращает оценку
+	Entity<Bits> Unpack(const char *record) const; // распаковка особи из записи
+
+	bool TryPush(size_t from, size_t to, const Genome<Bits> *genes, double score); // добавление мигранта, false при заполненном буфере
+	bool TryPop(size_t from, size_t to, Genome<Bits> *genes, double &score); // извлечение мигранта в буфер генов, false при пустом буфере
+
+	void Receive(size_t island, Population<Bits> &population, std::vector<Genome<Bits>> &migrant); // приём мигрантов от всех островов
+	void Send(size_t island, Population<Bits> &population, Random &random); // отправка лучших особей соседу
+	void RunIsland(size_t island, BatchFunction f); // эволюция одного острова в дочернем процессе
+	bool Reap(size_t island, bool block); // получение кода завершения процесса острова, false если процесс ещё работает
+	bool IsFailed(size_t island) const; // завершился ли процесс острова сигналом или с ошибкой
+public:
+	ProcessIslandModel(const std::vector<Config> &configs); // создание разделяемой памяти для островов
+	~ProcessIslandModel();
+
+	ProcessIslandModel(const ProcessIslandModel&) = delete;
+	ProcessIslandModel& operator=(const ProcessIslandModel&) = delete;
+
+	void Start(BatchFunction f); // запуск процессов островов
+	bool IsFinished(); // завершились ли все острова
+	size_t GetEpoch(); // число эпох, выполненных всеми работающими островами
+	double GetGlobalBest(); // получение текущего лучшего значения среди всех островов
+	void Stop(); // остановка всех островов
+	void Wait(); // ожидание завершения процессов и сбор итогов
+
+	const std::vector<IslandResult<Bits>>& GetResults() const; // получение итогов островов
+	size_t GetBestIsland() const; // получение номера острова с лучшей особью
+};
+
+// выравнивание размера на кэш-линию
+template <unsigned Bits>
+size_t ProcessIslandModel<Bits>::Align(size_t size) {
+	return (size + 63) / 64 * 64;
+}
+
+// создание разделяемой памяти для островов
+template <unsigned Bits>
+ProcessIslandModel<Bits>::ProcessIslandModel(const std::vector<Config> &configs) : configs(configs) {
+#if defined(__unix__)
+	islands = configs.size();
+	dimensions = configs[0].dimensions;
+	scale = configs[0].scale;
+
+	recordSize = sizeof(double) + dimensions * sizeof(Genome<Bits>);
+	capacity = 2;
+
+	for (size_t i = 0; i < islands; i++)
+		while (capacity < 4 * configs[i].migrationSize)
+			capacity *= 2;
+
+	ringSize = sizeof(SharedRingHeader) + Align(capacity * recordSize);
+
+	// флаг остановки, состояния островов, лучшие особи островов и буферы для каждой упорядоченной пары островов
+	memorySize = 64 + islands * sizeof(SharedIslandState) + islands * Align(recordSize) + islands * islands * ringSize;
+
+	std::string name = "/genetic-algorithm-" + std::to_string(getpid());
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+	if (fd < 0)
+		throw std::runtime_error("unable to create shared memory '" + name + "'");
+
+	if (ftruncate(fd, memorySize) != 0) {
+		close(fd);
+		shm_unlink(name.c_str());
+		throw std::runtime_error("unable to resize shared memory '" + name + "'");
+	}
+
+	void *address = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	// отображение наследуется дочерними процессами, поэтому имя больше не нужно и не останется в системе после завершения
+	close(fd);
+	shm_unlink(name.c_str());
+
+	if (address == MAP_FAILED)
+		throw std::runtime_error("unable to map shared memory '" + name + "'");
+
+	memory = (char *) address;
+	memset(memory, 0, memorySize);
+
+	new (memory) std::atomic<uint32_t>(0);
+
+	for (size_t i = 0; i < islands; i++) {
+		SharedIslandState *state = new (&GetState(i)) SharedIslandState();
+		state->epoch = 0;
+		state->best = -scale * std::numeric_limits<double>::infinity();
+		state->sent = 0;
+		state->received = 0;
+		state->dropped = 0;
+		state->finished = 0;
+	}
+
+	for (size_t from = 0; from < islands; from++) {
+		for (size_t to = 0; to < islands; to++) {
+			SharedRingHeader *ring = new (&GetRing(from, to)) SharedRingHeader();
+			ring->head = 0;
+			ring->tail = 0;
+		}
+	}
+
+	results.resize(islands);
+#else
+	throw std::runtime_error("process islands are supported only on POSIX systems");
+#endif
+}
+
+template <unsigned Bits>
+ProcessIslandModel<Bits>::~ProcessIslandModel() {
+#if defined(__unix__)
+	munmap(memory, memorySize);
+#endif
+}
+
+// флаг остановки всех островов
+template <unsigned Bits>
+std::atomic<uint32_t>& ProcessIslandModel<Bits>::GetStop() {
+	return *(std::atomic<uint32_t> *) memory;
+}
+
+// состояние острова
+template <unsigned Bits>
+SharedIslandState& ProcessIslandModel<Bits>::GetState(size_t island) {
+	return *(SharedIslandState *) (memory + 64 + island * sizeof(SharedIslandState));
+}
+
+// запись с лучшей особью острова
+template <unsigned Bits>
+char* ProcessIslandModel<Bits>::GetResult(size_t island) {
+	return memory + 64 + islands * sizeof(SharedIslandState) + island * Align(recordSize);
+}
+
+// кольцевой буфер от острова from к острову to
+template <unsigned Bits>
+SharedRingHeader& ProcessIslandModel<Bits>::GetRing(size_t from, size_t to) {
+	return *(SharedRingHeader *) (memory + 64 + islands * (sizeof(SharedIslandState) + Align(recordSize)) + (from * islands + to) * ringSize);
+}
+
+// запись кольцевого буфера
+template <unsigned Bits>
+char* ProcessIslandModel<Bits>::GetRecord(size_t from, size_t to, uint64_t index) {
+	return (char *) &GetRing(from, to) + sizeof(SharedRingHeader) + (index & (capacity - 1)) * recordSize;
+}
+
+// упаковка генов и оценки в запись: оценка, затем слова всех генов подряд
+template <unsigned Bits>
+void ProcessIslandModel<Bits>::Pack(const Genome<Bits> *genes, double score, char *record) const {
+	memcpy(record, &score, sizeof(double));
+	memcpy(record + sizeof(double), genes, dimensions * sizeof(Genome<Bits>));
+}
+
+// упаковка особи в запись
+template <unsigned Bits>
+void ProcessIslandModel<Bits>::Pack(const Entity<Bits> &entity, char *record) const {
+	Pack(entity.GetGenes(), entity.GetScore(), record);
+}
+
+// распаковка генов записи в буфер, возвращает оценку
+template <unsigned Bits>
+double ProcessIslandModel<Bits>::Unpack(const char *record, Genome<Bits> *genes) const {
+	double score;
+
+	memcpy(&score, record, sizeof(double));
+	memcpy(genes, record + sizeof(double), dimensions * sizeof(Genome<Bits>));
+
+	return score;
+}
+
+// распаковка особи из записи
+template <unsigned Bits>
+Entity<Bits> ProcessIslandModel<Bits>::Unpack(const char *record) const {
+	std::vector<Genome<Bits>> genes(dimensions);
+	double score = Unpack(record, genes.data());
+
+	return Entity<Bits>(genes.data(), dimensions, score);
+}
+
+// добавление мигранта, false при заполненном буфере
+template <unsigned Bits>
+bool ProcessIslandModel<Bits>::TryPush(size_t from, size_t to, const Genome<Bits> *genes, double score) {
+	SharedRingHeader &ring = GetRing(from, to);
+	uint64_t t = ring.tail.load(std::memory_order_relaxed);
+
+	if (t - ring.head.load(std::memory_order_acquire) >= capacity)
+		return false;
+
+	Pack(genes, score, GetRecord(from, to, t));
+	ring.tail.store(t + 1, std::memory_order_release); // публикуем запись читателю
+	return true;
+}
+
+// извлечение мигранта, false при пустом буфере
+template <unsigned Bits>
+bool ProcessIslandModel<Bits>::TryPop(size_t from, size_t to, Genome<Bits> *genes, double &score) {
+	SharedRingHeader &ring = GetRing(from, to);
+	uint64_t h = ring.head.load(std::memory_order_relaxed);
+
+	if (h == ring.tail.load(std::memory_order_acquire))
+		return false;
+
+	score = Unpack(GetRecord(from, to, h), genes);
+	ring.head.store(h + 1, std::memory_order_release); // освобождаем запись для писателя
+	return true;
+}
+
+// приём мигрантов от всех островов: мигранты распаковываются в буфер генов и замещают худших особей
+template <unsigned Bits>
+void ProcessIslandModel<Bits>::Receive(size_t island, Population<Bits> &population, std::vector<Genome<Bits>> &migrant) {
+	double score;
+
+	for (size_t from = 0; from < islands; from++) {
+		if (from == island)
+			continue;
+
+		while (TryPop(from, island, migrant.data(), score)) {
+			population.Immigrate(configs[island], migrant.data(), score);
+			GetState(island).received.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+// отправка лучших особей соседу по кольцу или случайному острову
+template <unsigned Bits>
+void ProcessIslandModel<Bits>::Send(size_t island, Population<Bits> &population, Random &random) {
+	const Config &config = configs[island];
+	size_t to = (island + 1) % islands;
+
+	if (config.migrationTopology == MigrationTopology::Random) {
+		to = random.GetInt(islands - 1);
+
+		if (to >= island)
+			to++; // пропускаем сам остров
+	}
+
+	// лучшие особи упаковываются прямо из популяции; при заполненном буфере мигранты отбрасываются: отправитель никогда не ждёт получателя
+	population.ForBestEntities(config, config.migrationSize, [this, island, to](const Genome<Bits> *genes, double score) {
+		if (TryPush(island, to, genes, score)) {
+			GetState(island).sent.fetch_add(1, std::memory_order_relaxed);
+		}
+		else {
+			GetState(island).dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+}
+
+// эволюция одного острова в дочернем процессе: критерий остановки по улучшению применяет координатор
+template <unsigned Bits>
+void ProcessIslandModel<Bits>::RunIsland(size_t island, BatchFunction f) {
+	const Config &config = configs[island];
+	SharedIslandState &state = GetState(island);
+
+	Population<Bits> population(config, island); // у каждого острова свой поток случайных чисел
+	Random random(config.seed, islands + island); // поток для выбора получателей мигрантов
+	std::vector<Genome<Bits>> migrant(dimensions); // гены принятого мигранта, выделяются один раз
+	Entity<Bits> bestEntity; // лучшая особь эпохи, память генов выделяется один раз
+	Entity<Bits> best;
+
+	for (size_t epoch = 0; epoch < config.maxEpochs && !GetStop().load(std::memory_order_acquire); epoch++) {
+		population.Eval(config, f); // оцениваем популяцию
+		Receive(island, population, migrant); // мигранты уже оценены и не требуют повторной оценки
+
+		population.GetBestEntity(config, bestEntity);
+
+		if (epoch == 0 || (bestEntity.GetScore() - best.GetScore()) * config.scale > 0) {
+			best = bestEntity;
+			state.best.store(best.GetScore(), std::memory_order_relaxed);
+		}
+
+		state.epoch.store(epoch + 1, std::memory_order_release);
+
+		if (islands > 1 && epoch % config.migrationInterval == config.migrationInterval - 1)
+			Send(island, population, random);
+
+		population.Selection(config); // запускаем селекцию
+
+		if (config.memeticElites > 0)
+			population.Refine(config, f); // улучшения защищённых особей учитываются при оценке следующей эпохи
+
+		population.Crossbreeding(config); // запускаем скрещивание
+		population.Mutation(config); // запускаем мутацию
+	}
+
+	if (best.GetDimensions() == dimensions)
+		Pack(best, GetResult(island));
+}
+
+// запуск процессов островов
+template <unsigned Bits>
+void ProcessIslandModel<Bits>::Start(BatchFunction f) {
+#if defined(__unix__)
+	std::cout.flush(); // иначе буфер вывода продублируется в дочерних процессах
+
+	for (size_t i = 0; i < islands; i++) {
+		pid_t pid = fork();
+
+		if (pid < 0) {
+			Stop();
+			throw std::runtime_error("unable to start island process");
+		}
+
+		if (pid == 0) {
+			int status = 0;
+
+			// привязка процесса к ядру, например по одному острову на узел NUMA
+			if (configs[i].pinThreads) {
+				long cores = sysconf(_SC_NPROCESSORS_ONLN);
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				CPU_SET(cores > 0 ? i % cores : 0, &set);
+				sched_setaffinity(0, sizeof(cpu_set_t), &set);
+			}
+
+			try {
+				RunIsland(i, f);
+			}
+			catch (const std::exception &e) {
+				std::cerr << "island " << i << ": " << e.what() << std::endl;
+				status = 1;
+			}
+
+			GetState(i).finished.store(1, std::memory_order_release);
+			_exit(status); // дочерний процесс не выполняет деструкторы и обработчики родителя
+		}
+
+		pids.push_back(pid);
+		statuses.push_back(0);
+		reaped.push_back(false);
+	}
+#endif
+}
+
+// получение кода завершения процесса острова (без ожидания, если block = false), false если процесс ещё работает
+template <unsigned Bits>
+bool ProcessIslandModel<Bits>::Reap(size_t island, bool block) {
+#if defined(__unix__)
+	if (reaped[island])
+		return true;
+
+	int status = 0;
+	pid_t pid = waitpid(pids[island], &status, block ? 0 : WNOHANG);
+
+	if (pid == 0)
+		return false;
+
+	reaped[island] = true;
+	statuses[island] = pid < 0 ? -1 : status;
+
+	// процесс, убитый сигналом, не успевает отметить завершение сам, и без этого координатор ждал бы его бесконечно
+	GetState(island).finished.store(1, std::memory_order_release);
+
+	if (IsFailed(island))
+		Stop(); // итог всё равно будет неполным, поэтому остальные острова тоже останавливаются
+#endif
+	return true;
+}
+
+// завершился ли процесс острова сигналом или с ошибкой
+template <unsigned Bits>
+bool ProcessIslandModel<Bits>::IsFailed(size_t island) const {
+#if defined(__unix__)
+	return statuses[island] < 0 || !WIFEXITED(statuses[island]) || WEXITSTATUS(statuses[island]) != 0;
+#else
+	return false;
+#endif
+}
+
+// завершились ли все острова: остров завершён, если отметил это сам или его процесс уже не существует
+template <unsigned Bits>
+bool ProcessIslandModel<Bits>::IsFinished() {
+	for (size_t i = 0; i < islands; i++)
+		if (!GetState(i).finished.load(std::memory_order_acquire) && (i >= pids.size() || !Reap(i, false)))
+			return false;
+
+	return true;
+}
+
+// число эпох, выполненных всеми работающими островами
+template <unsigned Bits>
+size_t ProcessIslandModel<Bits>::GetEpoch() {
+	size_t epoch = std::numeric_limits<size_t>::max();
+
+	for (size_t i = 0; i < islands; i++)
+		if (!GetState(i).finished.load(std::memory_order_acquire))
+			epoch = std::min(epoch, (size_t) GetState(i).epoch.load(std::memory_order_acquire));
+
+	// все острова завершились - берём наибольшее число эпох
+	if (epoch == std::numeric_limits<size_t>::max()) {
+		epoch = 0;
+
+		for (size_t i = 0; i < islands; i++)
+			epoch = std::max(epoch, (size_t) GetState(i).epoch.load(std::memory_order_acquire));
+	}
+
+	return epoch;
+}
+
+// получение текущего лучшего значения среди всех островов
+template <unsigned Bits>
+double ProcessIslandModel<Bits>::GetGlobalBest() {
+	double best = GetState(0).best.load(std::memory_order_relaxed);
+
+	for (size_t i = 1; i < islands; i++) {
+		double score = GetState(i).best.load(std::memory_order_relaxed);
+
+		if ((score - best) * scale > 0)
+			best = score;
+	}
+
+	return best;
+}
+
+// остановка всех островов
+template <unsigned Bits>
+void ProcessIslandModel<Bits>::Stop() {
+	GetStop().store(1, std::memory_order_release);
+}
+
+// ожидание завершения процессов и сбор итогов
+template <unsigned Bits>
+void ProcessIslandModel<Bits>::Wait() {
+#if defined(__unix__)
+	std::string failure = "";
+
+	for (size_t i = 0; i < pids.size(); i++) {
+		Reap(i, true);
+
+		if (!IsFailed(i) || failure != "")
+			continue;
+
+		if (statuses[i] >= 0 && WIFSIGNALED(statuses[i])) {
+			failure = "island " + std::to_string(i) + " process was killed by signal " + std::to_string(WTERMSIG(statuses[i]));
+		}
+		else {
+			failure = "island " + std::to_string(i) + " process failed";
+		}
+	}
+
+	pids.clear();
+	statuses.clear();
+	reaped.clear();
+
+	if (failure != "")
+		throw std::runtime_error(failure);
+
+	for (size_t i = 0; i < islands; i++) {
+		SharedIslandState &state = GetState(i);
+
+		results[i].best = Unpack(GetResult(i));
+		results[i].epochs = state.epoch;
+		results[i].sent = state.sent;
+		results[i].received = state.received;
+		results[i].dropped = state.dropped;
+	}
+#endif
+}
+
+// получение итогов островов
+template <unsigned Bits>
+const std::vector<IslandResult<Bits>>& ProcessIslandModel<Bits>::GetResults() const {
+	return results;
+}
+
+// получение номера острова с лучшей особью
+template <unsigned Bits>
+size_t ProcessIslandModel<Bits>::GetBestIsland() const {
+	size_t best = 0;
+
+	for (size_t i = 1; i < islands; i++)
+		if ((results[i].best.GetScore() - results[best].best.GetScore()) * scale > 0)
+			best = i;
+
+	return best;
+}
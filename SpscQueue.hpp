@@ -0,0 +1,127 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+// неблокирующая очередь фиксированного размера для одного писателя и одного читателя
+// элементы очереди - записи из width значений T, которые копируются в заранее выделенный кольцевой буфер,
+// поэтому при побитово копируемом T (например, упакованные особи) обмен не выделяет память;
+// записи с собственными буферами заполняются и читаются прямо в кольцевом буфере без копирования
+template <typename T>
+class SpscQueue {
+	std::vector<T> items; // кольцевой буфер записей
+	size_t width; // число значений в записи
+	size_t mask; // маска индекса (число записей - степень двойки)
+
+	std::atomic<size_t> head; // номер следующей читаемой записи (меняет только читатель)
+	char padding[64]; // разносит счётчики читателя и писателя по разным кэш-линиям
+	std::atomic<size_t> tail; // номер следующей записываемой записи (меняет только писатель)
+public:
+	SpscQueue(size_t capacity, size_t width = 1, const T &prototype = T()); // создание очереди не менее чем на capacity записей по width копий prototype
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	size_t GetWidth() const; // получение числа значений в записи
+	bool TryPush(const T *record); // добавление записи, false при заполненной очереди
+	bool TryPop(T *record); // извлечение записи, false при пустой очереди
+	bool TryPush(const T &item); // добавление записи из одного значения
+	bool TryPop(T &item); // извлечение записи из одного значения
+
+	T* TryBeginPush(); // получение свободной записи для заполнения на месте, nullptr при заполненной очереди
+	void EndPush(); // публикация записи, полученной TryBeginPush
+	const T* TryBeginPop(); // получение первой записи для чтения на месте, nullptr при пустой очереди
+	void EndPop(); // освобождение записи, полученной TryBeginPop
+};
+
+// создание очереди не менее чем на capacity записей по width копий prototype
+template <typename T>
+SpscQueue<T>::SpscQueue(size_t capacity, size_t width, const T &prototype) : width(width), head(0), tail(0) {
+	size_t size = 2;
+
+	while (size < capacity)
+		size *= 2;
+
+	items.assign(size * width, prototype); // буферы prototype копируются в каждую запись заранее
+	mask = size - 1;
+}
+
+// получение числа значений в записи
+template <typename T>
+size_t SpscQueue<T>::GetWidth() const {
+	return width;
+}
+
+// добавление записи, false при заполненной очереди
+template <typename T>
+bool SpscQueue<T>::TryPush(const T *record) {
+	T *slot = TryBeginPush();
+
+	if (!slot)
+		return false;
+
+	std::copy(record, record + width, slot);
+	EndPush();
+	return true;
+}
+
+// извлечение записи, false при пустой очереди
+template <typename T>
+bool SpscQueue<T>::TryPop(T *record) {
+	const T *slot = TryBeginPop();
+
+	if (!slot)
+		return false;
+
+	std::copy(slot, slot + width, record);
+	EndPop();
+	return true;
+}
+
+// добавление записи из одного значения
+template <typename T>
+bool SpscQueue<T>::TryPush(const T &item) {
+	return TryPush(&item);
+}
+
+// извлечение записи из одного значения
+template <typename T>
+bool SpscQueue<T>::TryPop(T &item) {
+	return TryPop(&item);
+}
+
+// получение свободной записи для заполнения на месте, nullptr при заполненной очереди
+template <typename T>
+T* SpscQueue<T>::TryBeginPush() {
+	size_t t = tail.load(std::memory_order_relaxed);
+
+	if (t - head.load(std::memory_order_acquire) > mask)
+		return nullptr;
+
+	return &items[(t & mask) * width];
+}
+
+// публикация записи, полученной TryBeginPush
+template <typename T>
+void SpscQueue<T>::EndPush() {
+	tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); // публикуем запись читателю
+}
+
+// получение первой записи для чтения на месте, nullptr при пустой очереди
+template <typename T>
+const T* SpscQueue<T>::TryBeginPop() {
+	size_t h = head.load(std::memory_order_relaxed);
+
+	if (h == tail.load(std::memory_order_acquire))
+		return nullptr;
+
+	return &items[(h & mask) * width];
+}
+
+// освобождение записи, полученной TryBeginPop
+template <typename T>
+void SpscQueue<T>::EndPop() {
+	head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); // освобождаем запись для писателя
+}
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cmath>
+
+#include "Config.hpp"
+#include "Random.hpp"
+#include "Entity.hpp"
+#include "Crossbreeding.hpp"
+#include "Mutation.hpp"
+#include "GeneticAlgorithm.hpp"
+#include "Diversity.hpp"
+
+// стационарный генетический алгоритм: каждый поток сам выводит потомка, оценивает его и вставляет в популяцию,
+// не дожидаясь остальных, поэтому медленные оценки не задерживают другие потоки
+// эпохой считаются populationSize оценок, критерии остановки те же, что у поколенческого алгоритма
+template <unsigned Bits, typename Fitness>
+class SteadyStateAlgorithm {
+public:
+	typedef std::function<void(SteadyStateAlgorithm&)> Callback; // обработчик эпохи
+
+private:
+	Config config; // конфигурация
+	Fitness fitness; // оценочная функция от точки
+	size_t dimensions; // число генов особи
+
+	std::vector<Genome<Bits>> genes; // гены оценённых особей подряд
+	std::vector<double> scores; // оценки особей
+	size_t size; // число оценённых особей (растёт до populationSize)
+	std::mutex mutex; // блокировка популяции (только на время отбора родителей и вставки потомка)
+	Diversity<Bits> diversity; // разнообразие генов, обновляемое при каждой вставке
+
+	std::atomic<size_t> created; // число выданных на оценку особей начальной популяции
+	std::atomic<bool> stopped; // нужно ли завершить потоки
+	std::atomic<bool> boosted; // повышена ли вероятность мутации из-за потери разнообразия
+
+	size_t evaluations; // число вставленных оценок
+	size_t epoch; // число завершённых эпох
+	size_t nochangingIterations; // число эпох без улучшения
+	double prevBest; // лучшее значение на конце предыдущей эпохи
+	Entity<Bits> best; // лучшая особь за всё время
+	bool hasBest; // найдена ли хотя бы одна особь
+	StopReason reason; // причина остановки
+	double seconds; // время работы в секундах
+
+	std::vector<Callback> epochEndCallbacks; // обработчики конца эпохи
+
+	size_t SelectParent(Random &random) const; // отбор родителя турниром
+	size_t SelectVictim(Random &random) const; // выбор заменяемой особи
+	bool Breed(Random &random, std::vector<Genome<Bits>> &parent1, std::vector<Genome<Bits>> &parent2); // копирование генов родителей
+	void Insert(const Genome<Bits> *child, double score, Random &random); // вставка оценённого потомка
+	void EndEpoch(); // проверка критериев остановки в конце эпохи
+	void Work(size_t worker); // цикл рабочего потока
+public:
+	SteadyStateAlgorithm(const Config &config, Fitness fitness); // создание алгоритма
+
+	void OnEpochEnd(const Callback &callback); // добавление обработчика, вызываемого под блокировкой популяции после каждых populationSize оценок
+	const Entity<Bits>& Run(); // выполнение до остановки в config.threads потоках, возвращает лучшую особь
+	void Stop(); // остановка алгоритма (из обработчика эпохи)
+
+	size_t GetEpoch() const; // получение числа завершённых эпох
+	size_t GetEvaluations() const; // получение числа оценок
+	size_t GetNochangingIterations() const; // получение числа эпох без улучшения
+	double GetSeconds() const; // получение времени работы
+	double GetEvaluationsPerSecond() const; // получение числа оценок в секунду
+	StopReason GetStopReason() const; // получение причины остановки
+	const Entity<Bits>& GetBestEntity() const; // получение лучшей особи за всё время
+	const Diversity<Bits>& GetDiversity() const; // получение разнообразия популяции (в обработчике эпохи)
+	bool IsBoosted() const; // повышена ли вероятность мутации из-за потери разнообразия
+};
+
+// создание алгоритма
+template <unsigned Bits, typename Fitness>
+SteadyStateAlgorithm<Bits, Fitness>::SteadyStateAlgorithm(const Config &config, Fitness fitness) : config(config), fitness(fitness), diversity(config.dimensions), created(0), stopped(false), boosted(false) {
+	dimensions = config.dimensions;
+	genes.resize(config.populationSize * dimensions);
+	scores.resize(config.populationSize);
+	size = 0;
+
+	evaluations = 0;
+	epoch = 0;
+	nochangingIterations = 0;
+	prevBest = 0;
+	hasBest = false;
+	reason = StopReason::None;
+	seconds = 0;
+}
+
+// отбор родителя турниром среди оценённых особей
+template <unsigned Bits, typename Fitness>
+size_t SteadyStateAlgorithm<Bits, Fitness>::SelectParent(Random &random) const {
+	size_t winner = random.GetInt(size);
+
+	for (size_t i = 1; i < config.tournamentSize; i++) {
+		size_t index = random.GetInt(size);
+
+		if ((scores[index] - scores[winner]) * config.scale > 0)
+			winner = index;
+	}
+
+	return winner;
+}
+
+// выбор заменяемой особи: худшая во всей популяции или худшая среди участников турнира
+template <unsigned Bits, typename Fitness>
+size_t SteadyStateAlgorithm<Bits, Fitness>::SelectVictim(Random &random) const {
+	if (config.replacementType == ReplacementType::Worst) {
+		size_t worst = 0;
+
+		for (size_t i = 1; i < size; i++)
+			if ((scores[worst] - scores[i]) * config.scale > 0)
+				worst = i;
+
+		return worst;
+	}
+
+	size_t loser = random.GetInt(size);
+
+	for (size_t i = 1; i < config.tournamentSize; i++) {
+		size_t index = random.GetInt(size);
+
+		if ((scores[loser] - scores[index]) * config.scale > 0)
+			loser = index;
+	}
+
+	return loser;
+}
+
+// копирование генов родителей, false - оценённых особей ещё слишком мало
+template <unsigned Bits, typename Fitness>
+bool SteadyStateAlgorithm<Bits, Fitness>::Breed(Random &random, std::vector<Genome<Bits>> &parent1, std::vector<Genome<Bits>> &parent2) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (size < 2)
+		return false;
+
+	size_t first = SelectParent(random);
+	size_t second = SelectParent(random);
+
+	// гены копируются, чтобы скрещивать их уже без блокировки
+	std::copy(genes.begin() + first * dimensions, genes.begin() + (first + 1) * dimensions, parent1.begin());
+	std::copy(genes.begin() + second * dimensions, genes.begin() + (second + 1) * dimensions, parent2.begin());
+	return true;
+}
+
+// вставка оценённого потомка: пока популяция не заполнена, потомок добавляется, затем замещает выбранную особь, если лучше неё
+template <unsigned Bits, typename Fitness>
+void SteadyStateAlgorithm<Bits, Fitness>::Insert(const Genome<Bits> *child, double score, Random &random) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (stopped)
+		return; // оценка завершилась уже после остановки
+
+	bool append = size < config.populationSize;
+	size_t index = append ? size++ : SelectVictim(random);
+
+	if (append || (score - scores[index]) * config.scale > 0) {
+		// особь меняется целиком, поэтому разнообразие обновляется по её битам без пересчёта всей популяции
+		if (!append)
+			diversity.Remove(&genes[index * dimensions]);
+
+		diversity.Add(child);
+		std::copy(child, child + dimensions, genes.begin() + index * dimensions);
+		scores[index] = score;
+	}
+
+	if (!hasBest || (score - best.GetScore()) * config.scale > 0) {
+		best = Entity<Bits>(child, dimensions, score);
+		hasBest = true;
+	}
+
+	if (++evaluations % config.populationSize == 0)
+		EndEpoch();
+}
+
+// проверка критериев остановки в конце эпохи
+template <unsigned Bits, typename Fitness>
+void SteadyStateAlgorithm<Bits, Fitness>::EndEpoch() {
+	double currBest = best.GetScore();
+
+	// если не нулевая эпоха и значение изменилось недостаточно сильно
+	if (epoch > 0 && fabs(prevBest - currBest) < config.qualityEpsilon) {
+		nochangingIterations++;
+
+		if (nochangingIterations >= config.maxValuelessEpochs)
+			reason = StopReason::Valueless;
+	}
+	else {
+		nochangingIterations = 0;
+	}
+
+	prevBest = currBest;
+	epoch++;
+	boosted = config.diversityPolicy == DiversityPolicy::Mutation && diversity.GetDiversity() < config.diversityThreshold;
+
+	for (size_t i = 0; i < epochEndCallbacks.size(); i++)
+		epochEndCallbacks[i](*this);
+
+	if (reason == StopReason::None && epoch >= config.maxEpochs)
+		reason = StopReason::MaxEpochs;
+
+	if (reason != StopReason::None)
+		stopped = true;
+}
+
+// цикл рабочего потока: под блокировкой только отбор родителей и вставка, скрещивание, мутация и оценка - без неё
+template <unsigned Bits, typename Fitness>
+void SteadyStateAlgorithm<Bits, Fitness>::Work(size_t worker) {
+	Random random(config.seed, worker + 1); // у каждого потока свой поток случайных чисел
+	std::vector<Genome<Bits>> parent1(dimensions);
+	std::vector<Genome<Bits>> parent2(dimensions);
+	std::vector<Genome<Bits>> child(dimensions);
+	std::vector<double> x(dimensions);
+	double boostedProbability = std::min(1.0, config.mutationProbability * config.diversityBoost);
+
+	while (!stopped) {
+		// сначала оцениваются случайные особи начальной популяции
+		if (created++ < config.populationSize || !Breed(random, parent1, parent2)) {
+			for (size_t i = 0; i < dimensions; i++)
+				child[i] = Genome<Bits>::GetRandom(random);
+		}
+		else {
+			Crossbreed(parent1.data(), parent2.data(), child.data(), dimensions, config.crossbreedingType, random);
+
+			if (random.GetReal() < (boosted ? boostedProbability : config.mutationProbability))
+				Mutate(child.data(), dimensions, config.mutationType, random);
+		}
+
+		Decode(config, child.data(), x.data());
+		Insert(child.data(), fitness(x.data(), dimensions), random);
+	}
+}
+
+// добавление обработчика, вызываемого под блокировкой популяции после каждых populationSize оценок
+template <unsigned Bits, typename Fitness>
+void SteadyStateAlgorithm<Bits, Fitness>::OnEpochEnd(const Callback &callback) {
+	epochEndCallbacks.push_back(callback);
+}
+
+// выполнение до остановки в config.threads потоках, возвращает лучшую особь
+template <unsigned Bits, typename Fitness>
+const Entity<Bits>& SteadyStateAlgorithm<Bits, Fitness>::Run() {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+
+	for (size_t i = 1; i < config.threads; i++)
+		workers.push_back(std::thread(&SteadyStateAlgorithm::Work, this, i));
+
+	Work(0); // вызывающий поток работает наравне с остальными
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return best;
+}
+
+// остановка алгоритма (из обработчика эпохи)
+template <unsigned Bits, typename Fitness>
+void SteadyStateAlgorithm<Bits, Fitness>::Stop() {
+	if (reason == StopReason::None)
+		reason = StopReason::Stopped;
+}
+
+// получение числа завершённых эпох
+template <unsigned Bits, typename Fitness>
+size_t SteadyStateAlgorithm<Bits, Fitness>::GetEpoch() const {
+	return epoch;
+}
+
+// получение числа оценок
+template <unsigned Bits, typename Fitness>
+size_t SteadyStateAlgorithm<Bits, Fitness>::GetEvaluations() const {
+	return evaluations;
+}
+
+// получение числа эпох без улучшения
+template <unsigned Bits, typename Fitness>
+size_t SteadyStateAlgorithm<Bits, Fitness>::GetNochangingIterations() const {
+	return nochangingIterations;
+}
+
+// получение времени работы
+template <unsigned Bits, typename Fitness>
+double SteadyStateAlgorithm<Bits, Fitness>::GetSeconds() const {
+	return seconds;
+}
+
+// получение числа оценок в секунду
+template <unsigned Bits, typename Fitness>
+double SteadyStateAlgorithm<Bits, Fitness>::GetEvaluationsPerSecond() const {
+	return seconds > 0 ? evaluations / seconds : 0;
+}
+
+// получение причины остановки
+template <unsigned Bits, typename Fitness>
+StopReason SteadyStateAlgorithm<Bits, Fitness>::GetStopReason() const {
+	return reason;
+}
+
+// получение лучшей особи за всё время
+template <unsigned Bits, typename Fitness>
+const Entity<Bits>& SteadyStateAlgorithm<Bits, Fitness>::GetBestEntity() const {
+	return best;
+}
+
+// получение разнообразия популяции (в обработчике эпохи, под блокировкой)
+template <unsigned Bits, typename Fitness>
+const Diversity<Bits>& SteadyStateAlgorithm<Bits, Fitness>::GetDiversity() const {
+	return diversity;
+}
+
+// повышена ли вероятность мутации из-за потери разнообразия
+template <unsigned Bits, typename Fitness>
+bool SteadyStateAlgorithm<Bits, Fitness>::IsBoosted() const {
+	return boosted;
+}
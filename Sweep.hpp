@@ -0,0 +1,203 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <set>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "Config.hpp"
+#include "ConfigParser.hpp"
+#include "Random.hpp"
+#include "WorkStealingPool.hpp"
+#include "GeneticAlgorithm.hpp"
+
+// сочетание значений перебираемых параметров
+struct SweepPoint {
+	Config config; // конфигурация сочетания
+	std::string name; // значения параметров сочетания
+};
+
+// итог одного запуска
+struct SweepRun {
+	double best; // лучшее найденное значение
+	size_t epochs; // число оценённых эпох
+	size_t evaluations; // число вызовов оценочной функции
+	double time; // время работы в секундах
+};
+
+// сводка запусков одного сочетания
+struct SweepResult {
+	std::string name; // значения параметров сочетания
+	size_t runs; // число запусков
+	double meanBest; // среднее лучшее значение
+	double deviationBest; // стандартное отклонение лучшего значения
+	double best; // лучшее значение по всем запускам
+	double epochs; // среднее число эпох
+	double evaluations; // среднее число вызовов оценочной функции
+	double time; // среднее время работы в секундах
+};
+
+// разбиение списка значений через запятую
+std::vector<std::string> SplitSweepValues(const std::string &values) {
+	std::vector<std::string> parts;
+	size_t start = 0;
+
+	while (start <= values.length()) {
+		size_t end = values.find(',', start);
+
+		if (end == std::string::npos)
+			end = values.length();
+
+		parts.push_back(values.substr(start, end - start));
+		start = end + 1;
+	}
+
+	return parts;
+}
+
+// получение сочетания с номером index: номер раскладывается по основаниям, равным числу значений параметров
+SweepPoint GetSweepPoint(ConfigParser &parser, const Config &config, const std::vector<std::vector<std::string>> &values, size_t index) {
+	std::vector<std::string> lines;
+	std::string name = "";
+
+	for (size_t i = 0; i < values.size(); i++) {
+		const std::string &key = config.sweepSettings[i].first;
+		const std::string &value = values[i][index % values[i].size()];
+		index /= values[i].size();
+
+		lines.push_back(key + " = " + value);
+		name += (i > 0 ? " " : "") + key + "=" + value;
+	}
+
+	return { parser.GetSweepConfig(config, lines), name };
+}
+
+// получение перебираемых сочетаний: все сочетания сетки или sweepSamples различных случайных
+std::vector<SweepPoint> GetSweepPoints(ConfigParser &parser, const Config &config) {
+	std::vector<std::vector<std::string>> values;
+	size_t total = 1;
+
+	for (size_t i = 0; i < config.sweepSettings.size(); i++) {
+		values.push_back(SplitSweepValues(config.sweepSettings[i].second));
+		total *= values[i].size();
+	}
+
+	std::vector<SweepPoint> points;
+
+	if (config.sweepMode == SweepMode::Grid || total <= config.sweepSamples) {
+		for (size_t i = 0; i < total; i++)
+			points.push_back(GetSweepPoint(parser, config, values, i));
+
+		return points;
+	}
+
+	Random random(config.seed);
+	std::set<size_t> used; // сочетания не повторяются
+
+	while (points.size() < config.sweepSamples) {
+		size_t index = random.Next() % total;
+
+		if (used.insert(index).second)
+			points.push_back(GetSweepPoint(parser, config, values, index));
+	}
+
+	return points;
+}
+
+// перебор: каждое сочетание запускается sweepSeeds раз с seed, seed + 1, ... (одинаковыми для всех сочетаний)
+template <unsigned Bits, typename Fitness>
+std::vector<SweepResult> RunSweep(const Config &config, const std::vector<SweepPoint> &points, Fitness f) {
+	size_t seeds = config.sweepSeeds;
+	std::vector<SweepRun> runs(points.size() * seeds);
+	WorkStealingPool pool(config.sweepThreads);
+
+	// запуски сходятся за очень разное число эпох, поэтому освободившиеся потоки забирают чужие задачи
+	for (size_t i = 0; i < runs.size(); i++) {
+		pool.Push([&config, &points, &runs, &f, seeds, i]() {
+			Config runConfig = points[i / seeds].config;
+			runConfig.seed = config.seed + i % seeds;
+			runConfig.threads = 1; // потоки заняты другими запусками
+			runConfig.telemetryFormat = TelemetryFormat::None;
+			runConfig.checkpointPath = "";
+			runConfig.resume = false;
+			runConfig.debug = false;
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			GeneticAlgorithm<Bits, Fitness> algorithm(runConfig, f);
+			size_t evaluations = 0;
+
+			algorithm.OnEvaluated([&evaluations](GeneticAlgorithm<Bits, Fitness> &algorithm) {
+				evaluations += algorithm.GetPopulation().GetEvaluations();
+			});
+
+			runs[i].best = algorithm.Run().GetScore();
+			runs[i].epochs = algorithm.GetEpoch() + (algorithm.GetStopReason() == StopReason::MaxEpochs ? 0 : 1); // последняя эпоха оценена, но не завершена
+			runs[i].evaluations = evaluations;
+			runs[i].time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		});
+	}
+
+	pool.Run();
+
+	std::vector<SweepResult> results(points.size());
+
+	for (size_t i = 0; i < points.size(); i++) {
+		SweepResult &result = results[i];
+		result.name = points[i].name;
+		result.runs = seeds;
+		result.meanBest = 0;
+		result.best = runs[i * seeds].best;
+		result.epochs = 0;
+		result.evaluations = 0;
+		result.time = 0;
+
+		double squares = 0;
+
+		for (size_t j = i * seeds; j < (i + 1) * seeds; j++) {
+			result.meanBest += runs[j].best;
+			squares += runs[j].best * runs[j].best;
+			result.epochs += runs[j].epochs;
+			result.evaluations += runs[j].evaluations;
+			result.time += runs[j].time;
+
+			if ((runs[j].best - result.best) * config.scale > 0)
+				result.best = runs[j].best;
+		}
+
+		result.meanBest /= seeds;
+		result.deviationBest = sqrt(std::max(0.0, squares / seeds - result.meanBest * result.meanBest));
+		result.epochs /= seeds;
+		result.evaluations /= seeds;
+		result.time /= seeds;
+	}
+
+	return results;
+}
+
+// вывод сводной таблицы перебора от лучшего среднего значения к худшему
+void PrintSweepResults(const Config &config, std::vector<SweepResult> results) {
+	std::stable_sort(results.begin(), results.end(), [&config](const SweepResult &a, const SweepResult &b) {
+		return (a.meanBest - b.meanBest) * config.scale > 0;
+	});
+
+	size_t width = 13;
+
+	for (size_t i = 0; i < results.size(); i++)
+		width = std::max(width, results[i].name.length());
+
+	std::cout << std::left << std::setw(width) << "configuration" << std::right;
+	std::cout << std::setw(6) << "runs" << std::setw(14) << "mean best" << std::setw(12) << "deviation" << std::setw(14) << "best";
+	std::cout << std::setw(10) << "epochs" << std::setw(14) << "evaluations" << std::setw(12) << "time, s" << '\n';
+
+	for (size_t i = 0; i < results.size(); i++) {
+		const SweepResult &result = results[i];
+
+		std::cout << std::left << std::setw(width) << result.name << std::right;
+		std::cout << std::setw(6) << result.runs << std::setw(14) << result.meanBest << std::setw(12) << result.deviationBest << std::setw(14) << result.best;
+		std::cout << std::setw(10) << result.epochs << std::setw(14) << result.evaluations << std::setw(12) << result.time << '\n';
+	}
+}
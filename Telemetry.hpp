@@ -0,0 +1,168 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Config.hpp"
+#include "Profiler.hpp"
+#include "SpscQueue.hpp"
+
+// запись телеметрии одной эпохи
+struct TelemetryRecord {
+	size_t epoch; // номер эпохи
+	double best; // лучшее значение
+	double mean; // среднее значение
+	double deviation; // стандартное отклонение значений
+	size_t evaluations; // число вызовов оценочной функции
+	double diversity; // разнообразие генов (см. Diversity.hpp)
+	double times[PHASES]; // время фаз эпохи в секундах (нули без GENETIC_PROFILE)
+
+	size_t entities; // число особей в снимке популяции (0 - без снимка)
+	size_t words; // число 64-битных слов на особь
+	std::vector<double> scores; // оценки особей снимка
+	std::vector<uint64_t> bits; // слова генов особей снимка подряд
+};
+
+// запись телеметрии в отдельном потоке: поток оптимизации заполняет записи прямо в кольцевом буфере,
+// буферы снимков в котором выделены заранее, поэтому передача записи не выделяет память и не копирует её
+class TelemetryWriter {
+	std::ofstream output; // файл телеметрии
+	TelemetryFormat format; // формат записей
+	SpscQueue<TelemetryRecord> queue; // кольцевой буфер записей
+	std::atomic<bool> stopped; // нужно ли завершить поток записи
+	size_t dropped; // число записей, не поместившихся в буфер
+	std::vector<char> buffer; // буфер файлового потока
+	std::thread thread; // поток записи
+
+	void Run(); // цикл потока записи
+	void Write(const TelemetryRecord &record); // запись одной эпохи в файл
+	void WriteBits(const TelemetryRecord &record, size_t entity); // запись генов особи шестнадцатеричными словами
+public:
+	TelemetryWriter(const std::string &path, TelemetryFormat format, size_t capacity, size_t entities, size_t words); // открытие файла, выделение записей под снимки из entities особей по words слов и запуск потока записи
+	~TelemetryWriter(); // дозапись оставшихся записей и остановка потока
+
+	TelemetryRecord* Acquire(); // получение свободной записи буфера для заполнения без ожидания, nullptr при заполненном буфере
+	void Publish(); // передача заполненной записи потоку записи
+	size_t GetDropped() const; // получение числа потерянных записей
+};
+
+// создание записи с буферами снимка из entities особей по words слов
+TelemetryRecord GetTelemetryPrototype(size_t entities, size_t words) {
+	TelemetryRecord record;
+	record.entities = 0;
+	record.words = words;
+	record.scores.resize(entities);
+	record.bits.resize(entities * words);
+	return record;
+}
+
+// открытие файла, выделение записей под снимки из entities особей по words слов и запуск потока записи
+TelemetryWriter::TelemetryWriter(const std::string &path, TelemetryFormat format, size_t capacity, size_t entities, size_t words) : format(format), queue(capacity, 1, GetTelemetryPrototype(entities, words)), stopped(false), dropped(0), buffer(1 << 20) {
+	output.rdbuf()->pubsetbuf(buffer.data(), buffer.size()); // крупный буфер вместо записи каждой строки
+	output.open(path);
+
+	if (!output)
+		throw std::runtime_error("unable to open telemetry file '" + path + "'");
+
+	if (format == TelemetryFormat::Csv)
+		output << "type,epoch,index,score,mean,deviation,evaluations,diversity,eval,selection,crossbreeding,mutation,bits\n";
+
+	thread = std::thread(&TelemetryWriter::Run, this);
+}
+
+// дозапись оставшихся записей и остановка потока
+TelemetryWriter::~TelemetryWriter() {
+	stopped.store(true, std::memory_order_release);
+	thread.join();
+	output.flush();
+}
+
+// цикл потока записи
+void TelemetryWriter::Run() {
+	while (true) {
+		bool stop = stopped.load(std::memory_order_acquire); // проверяем до опустошения буфера, чтобы не потерять последние записи
+
+		// запись форматируется прямо из кольцевого буфера и только затем освобождается для потока оптимизации
+		if (const TelemetryRecord *record = queue.TryBeginPop()) {
+			Write(*record);
+			queue.EndPop();
+			continue;
+		}
+
+		if (stop)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+// запись генов особи шестнадцатеричными словами, начиная со старшего
+void TelemetryWriter::WriteBits(const TelemetryRecord &record, size_t entity) {
+	char word[17];
+
+	for (size_t i = record.words; i > 0; i--) {
+		snprintf(word, sizeof(word), "%016llx", (unsigned long long) record.bits[entity * record.words + i - 1]);
+		output << word;
+	}
+}
+
+// запись одной эпохи в файл
+void TelemetryWriter::Write(const TelemetryRecord &record) {
+	const double *t = record.times;
+
+	if (format == TelemetryFormat::Csv) {
+		// строки эпох и особей снимка различаются первым столбцом
+		output << "epoch," << record.epoch << ",," << record.best << "," << record.mean << "," << record.deviation << "," << record.evaluations << "," << record.diversity;
+		output << "," << t[0] << "," << t[1] << "," << t[2] << "," << t[3] << ",\n";
+
+		for (size_t i = 0; i < record.entities; i++) {
+			output << "entity," << record.epoch << "," << i << "," << record.scores[i] << ",,,,,,,,,";
+			WriteBits(record, i);
+			output << "\n";
+		}
+	}
+	else {
+		output << "{\"type\":\"epoch\",\"epoch\":" << record.epoch << ",\"best\":" << record.best << ",\"mean\":" << record.mean << ",\"deviation\":" << record.deviation << ",\"evaluations\":" << record.evaluations << ",\"diversity\":" << record.diversity;
+		output << ",\"times\":{\"eval\":" << t[0] << ",\"selection\":" << t[1] << ",\"crossbreeding\":" << t[2] << ",\"mutation\":" << t[3] << "}}\n";
+
+		if (record.entities > 0) {
+			output << "{\"type\":\"population\",\"epoch\":" << record.epoch << ",\"entities\":[";
+
+			for (size_t i = 0; i < record.entities; i++) {
+				output << (i > 0 ? "," : "") << "{\"score\":" << record.scores[i] << ",\"bits\":\"";
+				WriteBits(record, i);
+				output << "\"}";
+			}
+
+			output << "]}\n";
+		}
+	}
+}
+
+// получение свободной записи буфера для заполнения без ожидания, nullptr при заполненном буфере
+TelemetryRecord* TelemetryWriter::Acquire() {
+	TelemetryRecord *record = queue.TryBeginPush();
+
+	if (!record)
+		dropped++; // поток оптимизации никогда не ждёт записи на диск
+
+	return record;
+}
+
+// передача заполненной записи потоку записи
+void TelemetryWriter::Publish() {
+	queue.EndPush();
+}
+
+// получение числа потерянных записей
+size_t TelemetryWriter::GetDropped() const {
+	return dropped;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// постоянный пул потоков для параллельной обработки диапазонов
+class ThreadPool {
+	std::vector<std::thread> workers; // рабочие потоки
+	std::mutex mutex; // мьютекс для синхронизации
+	std::condition_variable startCondition; // сигнал о появлении новой задачи
+	std::condition_variable finishCondition; // сигнал о завершении задачи
+
+	// текущая задача хранится как указатель на объект вызывающего и функция его вызова, поэтому запуск задачи не выделяет память
+	const void *task; // объект задачи
+	void (*invoke)(const void *task, size_t begin, size_t end); // вызов задачи для части диапазона
+	size_t taskSize; // размер обрабатываемого диапазона
+	size_t generation; // номер текущей задачи
+	size_t remaining; // число потоков, ещё не закончивших задачу
+	bool stop; // флаг остановки пула
+
+	void GetChunk(size_t chunk, size_t &begin, size_t &end) const; // получение границ части диапазона
+	void Work(size_t chunk); // цикл рабочего потока
+	void Run(size_t size, const void *task, void (*invoke)(const void *, size_t, size_t)); // обработка диапазона задачей, заданной указателями
+
+	template <typename Task>
+	static void Invoke(const void *task, size_t begin, size_t end); // вызов задачи известного типа
+public:
+	ThreadPool(size_t threads); // создание пула с заданным числом потоков (включая вызывающий)
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	size_t GetThreads() const; // получение числа потоков
+
+	template <typename Task>
+	void ParallelFor(size_t size, const Task &task); // обработка диапазона [0, size) частями функцией, функтором или лямбдой от (begin, end)
+};
+
+// создание пула с заданным числом потоков (включая вызывающий)
+ThreadPool::ThreadPool(size_t threads) {
+	task = nullptr;
+	invoke = nullptr;
+	taskSize = 0;
+	generation = 0;
+	remaining = 0;
+	stop = false;
+
+	// вызывающий поток тоже обрабатывает свою часть, поэтому создаём на один поток меньше
+	for (size_t i = 1; i < threads; i++)
+		workers.push_back(std::thread(&ThreadPool::Work, this, i));
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop = true;
+	}
+
+	startCondition.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+// получение границ части диапазона
+void ThreadPool::GetChunk(size_t chunk, size_t &begin, size_t &end) const {
+	size_t chunks = workers.size() + 1;
+
+	begin = taskSize * chunk / chunks;
+	end = taskSize * (chunk + 1) / chunks;
+}
+
+// цикл рабочего потока
+void ThreadPool::Work(size_t chunk) {
+	size_t seen = 0; // номер последней обработанной задачи
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			while (!stop && generation == seen)
+				startCondition.wait(lock);
+
+			if (stop)
+				return;
+
+			seen = generation;
+		}
+
+		size_t begin, end;
+		GetChunk(chunk, begin, end);
+
+		if (begin < end)
+			invoke(task, begin, end);
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if (--remaining == 0)
+			finishCondition.notify_one();
+	}
+}
+
+// получение числа потоков
+size_t ThreadPool::GetThreads() const {
+	return workers.size() + 1;
+}
+
+// вызов задачи известного типа
+template <typename Task>
+void ThreadPool::Invoke(const void *task, size_t begin, size_t end) {
+	(*static_cast<const Task *>(task))(begin, end);
+}
+
+// обработка диапазона [0, size) частями: задача живёт в вызывающем потоке до возврата, поэтому достаточно указателя на неё
+template <typename Task>
+void ThreadPool::ParallelFor(size_t size, const Task &task) {
+	Run(size, &task, &ThreadPool::Invoke<Task>);
+}
+
+// обработка диапазона задачей, заданной указателями
+void ThreadPool::Run(size_t size, const void *task, void (*invoke)(const void *, size_t, size_t)) {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		this->task = task;
+		this->invoke = invoke;
+		taskSize = size;
+		remaining = workers.size();
+		generation++;
+	}
+
+	startCondition.notify_all();
+
+	// обрабатываем свою часть в вызывающем потоке
+	size_t begin, end;
+	GetChunk(0, begin, end);
+
+	if (begin < end)
+		invoke(task, begin, end);
+
+	// дожидаемся завершения остальных частей
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (remaining > 0)
+		finishCondition.wait(lock);
+}
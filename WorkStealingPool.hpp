@@ -0,0 +1,113 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+// пул потоков с перехватом задач: у каждого потока своя очередь, освободившийся поток забирает задачи из чужих очередей
+class WorkStealingPool {
+	// очередь задач одного потока
+	struct Queue {
+		std::mutex mutex; // мьютекс очереди (задачи крупные, поэтому блокировка не заметна)
+		std::deque<std::function<void()>> tasks; // задачи очереди
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues; // очереди потоков
+	std::atomic<size_t> next; // очередь для следующей добавляемой задачи
+	std::atomic<size_t> steals; // число перехваченных задач
+
+	bool Pop(size_t index, std::function<void()> &task); // получение задачи с конца своей очереди
+	bool Steal(size_t index, std::function<void()> &task); // перехват задачи с начала чужой очереди
+	void Work(size_t index); // цикл рабочего потока
+public:
+	WorkStealingPool(size_t threads); // создание пула с заданным числом потоков
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	size_t GetThreads() const; // получение числа потоков
+	size_t GetSteals() const; // получение числа перехваченных задач
+	void Push(const std::function<void()> &task); // добавление задачи в очередь очередного потока
+	void Run(); // выполнение всех добавленных задач (вызывающий поток работает наравне с остальными)
+};
+
+// создание пула с заданным числом потоков
+WorkStealingPool::WorkStealingPool(size_t threads) : next(0), steals(0) {
+	for (size_t i = 0; i < std::max(threads, (size_t) 1); i++)
+		queues.push_back(std::unique_ptr<Queue>(new Queue()));
+}
+
+// получение задачи с конца своей очереди
+bool WorkStealingPool::Pop(size_t index, std::function<void()> &task) {
+	Queue &queue = *queues[index];
+	std::unique_lock<std::mutex> lock(queue.mutex);
+
+	if (queue.tasks.empty())
+		return false;
+
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+	return true;
+}
+
+// перехват задачи с начала чужой очереди, начиная с соседнего потока
+bool WorkStealingPool::Steal(size_t index, std::function<void()> &task) {
+	for (size_t i = 1; i < queues.size(); i++) {
+		Queue &queue = *queues[(index + i) % queues.size()];
+		std::unique_lock<std::mutex> lock(queue.mutex);
+
+		if (queue.tasks.empty())
+			continue;
+
+		task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+		steals++;
+		return true;
+	}
+
+	return false;
+}
+
+// цикл рабочего потока: задачи только расходуются, поэтому пустые очереди у всех означают конец работы
+void WorkStealingPool::Work(size_t index) {
+	std::function<void()> task;
+
+	while (Pop(index, task) || Steal(index, task))
+		task();
+}
+
+// получение числа потоков
+size_t WorkStealingPool::GetThreads() const {
+	return queues.size();
+}
+
+// получение числа перехваченных задач
+size_t WorkStealingPool::GetSteals() const {
+	return steals;
+}
+
+// добавление задачи в очередь очередного потока
+void WorkStealingPool::Push(const std::function<void()> &task) {
+	Queue &queue = *queues[next++ % queues.size()];
+	std::unique_lock<std::mutex> lock(queue.mutex);
+	queue.tasks.push_back(task);
+}
+
+// выполнение всех добавленных задач (вызывающий поток работает наравне с остальными)
+void WorkStealingPool::Run() {
+	std::vector<std::thread> workers;
+
+	for (size_t i = 1; i < queues.size(); i++)
+		workers.push_back(std::thread(&WorkStealingPool::Work, this, i));
+
+	Work(0);
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
@@ -0,0 +1,804 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+#include "Config.hpp"
+#include "Population.hpp"
+#include "GeneticAlgorithm.hpp"
+#include "SteadyState.hpp"
+#include "Expression.hpp"
+#include "Pareto.hpp"
+#include "FitnessPlugin.hpp"
+
+using namespace std;
+
+atomic<size_t> allocationsCount(0); // число выделений памяти через operator new с начала работы
+
+// выделение памяти с подсчётом: по счётчику проверяется, что цикл поколений не выделяет память
+// (замены не встраиваются, иначе компилятор сопоставляет free с operator new и предупреждает о несоответствии)
+__attribute__((noinline)) void* operator new(size_t size) {
+	allocationsCount.fetch_add(1, memory_order_relaxed);
+
+	if (void *memory = malloc(size > 0 ? size : 1))
+		return memory;
+
+	throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+	free(memory);
+}
+
+// функция Растригина: минимум 0 в нуле
+double Rastrigin(const double *x, size_t dimensions) {
+	double sum = 10 * dimensions;
+
+	for (size_t i = 0; i < dimensions; i++)
+		sum += x[i] * x[i] - 10 * cos(2 * M_PI * x[i]);
+
+	return sum;
+}
+
+// функция Экли: минимум 0 в нуле
+double Ackley(const double *x, size_t dimensions) {
+	double squares = 0;
+	double cosines = 0;
+
+	for (size_t i = 0; i < dimensions; i++) {
+		squares += x[i] * x[i];
+		cosines += cos(2 * M_PI * x[i]);
+	}
+
+	return -20 * exp(-0.2 * sqrt(squares / dimensions)) - exp(cosines / dimensions) + 20 + M_E;
+}
+
+// функция Швефеля: минимум 0 в точке (420.9687, ..., 420.9687)
+double Schwefel(const double *x, size_t dimensions) {
+	double sum = 418.9828872724339 * dimensions;
+
+	for (size_t i = 0; i < dimensions; i++)
+		sum -= x[i] * sin(sqrt(fabs(x[i])));
+
+	return sum;
+}
+
+// функция Гриванка: минимум 0 в нуле
+double Griewank(const double *x, size_t dimensions) {
+	double sum = 0;
+	double product = 1;
+
+	for (size_t i = 0; i < dimensions; i++) {
+		sum += x[i] * x[i] / 4000;
+		product *= cos(x[i] / sqrt(i + 1.0));
+	}
+
+	return sum - product + 1;
+}
+
+// функция из main.cpp: сумма f по всем координатам
+double Sample(const double *x, size_t dimensions) {
+	double sum = 0;
+
+	for (size_t i = 0; i < dimensions; i++)
+		sum += x[i] * sin(x[i] + 5) * cos(x[i] - 6) * sin(x[i] + 7) * cos(x[i] - 8) * sin(x[i] / 3);
+
+	return sum;
+}
+
+// функция Растригина с переменным временем вычисления от 10 мкс до 1 мс, зависящим от точки,
+// как у дорогих оценочных функций, время работы которых сильно различается
+double VariableLatency(const double *x, size_t dimensions) {
+	double u = fabs(sin(x[0] * 12.9898 + 78.233) * 43758.5453);
+	u -= floor(u);
+
+	auto deadline = chrono::steady_clock::now() + chrono::microseconds((long) (10 * pow(100.0, u)));
+
+	while (chrono::steady_clock::now() < deadline)
+		;
+
+	return Rastrigin(x, dimensions);
+}
+
+// пакетная оценка функции F
+template <double (*F)(const double *, size_t)>
+void Batch(const double *x, double *scores, size_t n, size_t dimensions) {
+	for (size_t i = 0; i < n; i++)
+		scores[i] = F(x + i * dimensions, dimensions);
+}
+
+// тестовая функция с областью поиска и целевым значением
+struct TestFunction {
+	string name; // название функции
+	BatchFunction f; // пакетная оценка
+	double left; // левая граница по каждому измерению
+	double right; // правая граница по каждому измерению
+	double target; // значение, достижение которого считается сходимостью
+};
+
+// результат одного измерения
+struct Measurement {
+	string benchmark; // группа измерений (operator, generation, convergence)
+	string name; // измеряемая операция или функция
+	size_t size; // размер популяции
+	string metric; // измеряемая величина
+	double value; // значение
+};
+
+// параметры запуска бенчмарка
+struct Options {
+	size_t maxSize; // наибольший размер популяции
+	size_t dimensions; // число измерений тестовых функций
+	string baseline; // файл с результатами для сравнения
+	double threshold; // допустимое относительное ухудшение
+	size_t threads; // число потоков для сравнения поколенческого и стационарного алгоритмов
+	string plugin; // библиотека из plugins/ExamplePlugin.cpp для проверки загрузки оценочной функции (пустая строка - без проверки)
+};
+
+// время в секундах с момента start
+double GetSeconds(chrono::steady_clock::time_point start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// конфигурация для измерений на популяции заданного размера
+Config GetBenchmarkConfig(size_t populationSize, size_t dimensions, double left, double right) {
+	Config config = GetDefaultConfig();
+
+	config.mode = "min";
+	config.dimensions = dimensions;
+	config.leftBorders = { left };
+	config.rightBorders = { right };
+	config.populationSize = populationSize;
+	config.seed = 42; // все запуски воспроизводимы
+	EvalConfig(config);
+
+	return config;
+}
+
+// число повторов, чтобы каждое измерение обрабатывало примерно одинаковое число особей
+size_t GetRepeats(size_t populationSize) {
+	return max((size_t) 1, (size_t) 2000000 / populationSize);
+}
+
+// измерение каждого оператора в отдельности
+void MeasureOperators(size_t size, const Options &options, vector<Measurement> &measurements) {
+	Config config = GetBenchmarkConfig(size, options.dimensions, -5.12, 5.12);
+	size_t repeats = GetRepeats(size);
+
+	// оценка всей популяции: каждый повтор начинается с новой популяции, все особи требуют оценки
+	double seconds = 0;
+
+	for (size_t i = 0; i < max((size_t) 1, repeats / 10); i++) {
+		Population<30> population(config, i);
+		auto start = chrono::steady_clock::now();
+		population.Eval(config, Batch<Rastrigin>);
+		seconds += GetSeconds(start);
+	}
+
+	measurements.push_back({ "operator", "eval", size, "ns_per_entity", seconds * 1e9 / (max((size_t) 1, repeats / 10) * size) });
+
+	Population<30> population(config);
+	population.Eval(config, Batch<Rastrigin>);
+
+	const SelectionType selections[] = { SelectionType::Random, SelectionType::Tournament, SelectionType::Roullete, SelectionType::Cut };
+	const char *selectionNames[] = { "selection_random", "selection_tournament", "selection_roulette", "selection_cut" };
+
+	for (int i = 0; i < 4; i++) {
+		Config selectionConfig = config;
+		selectionConfig.selectionType = selections[i];
+
+		auto start = chrono::steady_clock::now();
+
+		for (size_t j = 0; j < repeats; j++)
+			population.Selection(selectionConfig);
+
+		measurements.push_back({ "operator", selectionNames[i], size, "ns_per_entity", GetSeconds(start) * 1e9 / (repeats * size) });
+	}
+
+	const CrossbreedingType crossbreedings[] = { CrossbreedingType::OnePoint, CrossbreedingType::TwoPoint, CrossbreedingType::Uniform };
+	const char *crossbreedingNames[] = { "crossbreeding_one_point", "crossbreeding_two_point", "crossbreeding_uniform" };
+
+	for (int i = 0; i < 3; i++) {
+		Config crossbreedingConfig = config;
+		crossbreedingConfig.crossbreedingType = crossbreedings[i];
+
+		auto start = chrono::steady_clock::now();
+
+		// родители отобраны один раз, скрещивание повторяется на них
+		for (size_t j = 0; j < repeats; j++)
+			population.Crossbreeding(crossbreedingConfig);
+
+		measurements.push_back({ "operator", crossbreedingNames[i], size, "ns_per_entity", GetSeconds(start) * 1e9 / (repeats * size) });
+	}
+
+	const MutationType mutations[] = { MutationType::Random, MutationType::Swap, MutationType::Reverse };
+	const char *mutationNames[] = { "mutation_random", "mutation_swap", "mutation_reverse" };
+
+	for (int i = 0; i < 3; i++) {
+		Config mutationConfig = config;
+		mutationConfig.mutationType = mutations[i];
+		mutationConfig.mutationProbability = 1; // мутируют все незащищённые особи
+
+		auto start = chrono::steady_clock::now();
+
+		for (size_t j = 0; j < repeats; j++)
+			population.Mutation(mutationConfig);
+
+		measurements.push_back({ "operator", mutationNames[i], size, "ns_per_entity", GetSeconds(start) * 1e9 / (repeats * size) });
+	}
+}
+
+// подсчёт выделений памяти за несколько поколений после первого, во время которого заполняются кэш и буферы
+size_t CountGenerationAllocations(const Config &config) {
+	Population<30> population(config);
+	size_t allocations = 0;
+
+	for (size_t i = 0; i < 5; i++) {
+		size_t before = allocationsCount.load();
+
+		population.Eval(config, Batch<Rastrigin>);
+		population.Selection(config);
+		population.Crossbreeding(config);
+		population.Mutation(config);
+
+		if (i > 0)
+			allocations += allocationsCount.load() - before;
+	}
+
+	return allocations;
+}
+
+// подсчёт выделений памяти за несколько эпох GeneticAlgorithm::Step() после первой: кроме операторов популяции
+// эпоха алгоритма копирует лучшую особь, считает разнообразие и выполняет локальный поиск
+size_t CountStepAllocations(Config config) {
+	config.maxEpochs = 10;
+	config.maxValuelessEpochs = 10; // алгоритм не останавливается до конца подсчёта
+
+	auto algorithm = MakeGeneticAlgorithm<30>(config, Batch<Rastrigin>);
+	size_t allocations = 0;
+
+	for (size_t i = 0; i < 5; i++) {
+		size_t before = allocationsCount.load();
+		algorithm.Step();
+
+		if (i > 0)
+			allocations += allocationsCount.load() - before;
+	}
+
+	return allocations;
+}
+
+// число полных поколений в секунду популяции с набором операторов Operators
+template <typename Operators>
+double GetGenerationsPerSecond(const Config &config, size_t generations) {
+	if (!Operators::Matches(config))
+		throw runtime_error("operators do not match the benchmark configuration");
+
+	Population<30, Operators> population(config);
+	auto start = chrono::steady_clock::now();
+
+	for (size_t i = 0; i < generations; i++) {
+		population.Eval(config, Batch<Rastrigin>);
+		population.Selection(config);
+		population.Crossbreeding(config);
+		population.Mutation(config);
+	}
+
+	return generations / GetSeconds(start);
+}
+
+// измерение числа полных поколений в секунду
+void MeasureGenerations(size_t size, const Options &options, vector<Measurement> &measurements) {
+	Config config = GetBenchmarkConfig(size, options.dimensions, -5.12, 5.12);
+	size_t generations = max((size_t) 3, GetRepeats(size) / 10);
+
+	measurements.push_back({ "generation", "rastrigin", size, "generations_per_second", GetGenerationsPerSecond<RuntimeOperators>(config, generations) });
+
+	// одна и та же конфигурация из списка SpecializedOperators с выбором операторов во время работы и при компиляции
+	Config operatorsConfig = config;
+	operatorsConfig.mutationType = MutationType::Reverse;
+
+	measurements.push_back({ "operators", "runtime", size, "generations_per_second", GetGenerationsPerSecond<RuntimeOperators>(operatorsConfig, generations) });
+	measurements.push_back({ "operators", "static", size, "generations_per_second", GetGenerationsPerSecond<StaticOperators<SelectionType::Roullete, CrossbreedingType::TwoPoint, MutationType::Reverse, Minimize>>(operatorsConfig, generations) });
+
+	// параллельная оценка и кэш тоже не должны выделять память в цикле поколений
+	Config parallelConfig = config;
+	parallelConfig.threads = 4;
+	parallelConfig.parallelThreshold = 0;
+	parallelConfig.cacheSize = size;
+
+	if (CountGenerationAllocations(config) > 0 || CountGenerationAllocations(parallelConfig) > 0)
+		throw runtime_error("generation loop allocates memory");
+
+	Config memeticConfig = config;
+	memeticConfig.memeticElites = 2;
+	memeticConfig.memeticBudget = 50;
+
+	Config diversityConfig = config;
+	diversityConfig.diversityPolicy = DiversityPolicy::Mutation;
+	diversityConfig.diversityThreshold = 1; // разнообразие всегда ниже порога, поэтому усиленная мутация работает каждую эпоху
+
+	if (CountStepAllocations(config) > 0 || CountStepAllocations(parallelConfig) > 0 || CountStepAllocations(memeticConfig) > 0 || CountStepAllocations(diversityConfig) > 0)
+		throw runtime_error("algorithm step allocates memory");
+}
+
+// измерение скорости сходимости: число вычислений функции до достижения целевого значения
+void MeasureConvergence(const TestFunction &function, const Options &options, vector<Measurement> &measurements) {
+	Config config = GetBenchmarkConfig(100, options.dimensions, function.left, function.right);
+	config.selectionType = SelectionType::Tournament;
+	config.maxEpochs = 5000;
+
+	Population<30> population(config);
+	size_t evaluations = 0;
+	size_t epoch = 0;
+	bool reached = false;
+
+	for (; epoch < config.maxEpochs && !reached; epoch++) {
+		population.Eval(config, function.f);
+		evaluations += population.GetEvaluations();
+		reached = population.GetBestEntity(config).GetScore() <= function.target;
+
+		population.Selection(config);
+		population.Crossbreeding(config);
+		population.Mutation(config);
+	}
+
+	// недостигнутая цель обозначается отрицательным значением
+	measurements.push_back({ "convergence", function.name, config.populationSize, "evaluations", reached ? (double) evaluations : -1.0 });
+	measurements.push_back({ "convergence", function.name, config.populationSize, "epochs", reached ? (double) epoch : -1.0 });
+}
+
+// сравнение действий при потере разнообразия: доля запусков, достигших цели до остановки по max_valueless_epochs, и среднее число вычислений функции в них
+void MeasureDiversity(const Options &options, vector<Measurement> &measurements) {
+	const DiversityPolicy policies[] = { DiversityPolicy::None, DiversityPolicy::Mutation, DiversityPolicy::Restart };
+	const char *policyNames[] = { "none", "mutation", "restart" };
+	const size_t runs = 20;
+
+	for (int i = 0; i < 3; i++) {
+		size_t reached = 0;
+		double evaluations = 0;
+
+		for (size_t run = 0; run < runs; run++) {
+			Config config = GetBenchmarkConfig(100, options.dimensions * 2, -5.12, 5.12);
+			config.selectionType = SelectionType::Tournament;
+			config.maxEpochs = 2000;
+			config.maxValuelessEpochs = 30;
+			config.seed = run;
+			config.diversityPolicy = policies[i];
+
+			auto algorithm = MakeGeneticAlgorithm<30>(config, Batch<Rastrigin>);
+			size_t runEvaluations = 0;
+			bool runReached = false;
+
+			algorithm.OnEvaluated([&](decltype(algorithm) &algorithm) {
+				runEvaluations += algorithm.GetPopulation().GetEvaluations();
+
+				if (algorithm.GetEpochBest().GetScore() <= 1e-2) {
+					runReached = true;
+					algorithm.Stop();
+				}
+			});
+
+			algorithm.Run();
+
+			if (runReached) {
+				reached++;
+				evaluations += runEvaluations;
+			}
+		}
+
+		measurements.push_back({ "diversity", policyNames[i], 100, "reached", (double) reached / runs });
+		measurements.push_back({ "diversity", policyNames[i], 100, "evaluations", reached > 0 ? evaluations / reached : -1.0 });
+	}
+}
+
+// сравнение скорости оценки выражения из конфигурации и той же функции, скомпилированной в программу
+void MeasureExpression(size_t size, const Options &options, vector<Measurement> &measurements) {
+	const char *names[] = { "sample", "rastrigin" };
+	const char *texts[] = { "x*sin(x+5)*cos(x-6)*sin(x+7)*cos(x-8)*sin(x/3)", "10 + x^2 - 10*cos(2*pi*x)" };
+	const BatchFunction functions[] = { Batch<Sample>, Batch<Rastrigin> };
+
+	size_t repeats = GetRepeats(size);
+	vector<double> x(size * options.dimensions);
+	vector<double> scores(size);
+	Random random(42);
+
+	for (size_t i = 0; i < x.size(); i++)
+		x[i] = -5 + 10 * random.GetReal();
+
+	for (int i = 0; i < 2; i++) {
+		Expression expression(texts[i], options.dimensions);
+		auto start = chrono::steady_clock::now();
+
+		for (size_t j = 0; j < repeats; j++)
+			functions[i](x.data(), scores.data(), size, options.dimensions);
+
+		measurements.push_back({ "expression", string(names[i]) + "_compiled", size, "ns_per_point", GetSeconds(start) * 1e9 / (repeats * size) });
+
+		start = chrono::steady_clock::now();
+
+		for (size_t j = 0; j < repeats; j++)
+			expression.Evaluate(x.data(), scores.data(), size);
+
+		measurements.push_back({ "expression", string(names[i]) + "_bytecode", size, "ns_per_point", GetSeconds(start) * 1e9 / (repeats * size) });
+
+		// оценка по одной точке, как у стационарного алгоритма и функции F в main.cpp
+		size_t allocations = allocationsCount.load();
+		start = chrono::steady_clock::now();
+
+		for (size_t j = 0; j < repeats; j++)
+			for (size_t k = 0; k < size; k++)
+				expression.Evaluate(&x[k * options.dimensions], &scores[k], 1);
+
+		double seconds = GetSeconds(start);
+
+		if (allocationsCount.load() != allocations)
+			throw runtime_error("expression evaluation allocates memory");
+
+		measurements.push_back({ "expression", string(names[i]) + "_bytecode_point", size, "ns_per_point", seconds * 1e9 / (repeats * size) });
+	}
+}
+
+// сравнение числа вычислений функции до достижения цели без локального поиска и с локальным поиском по битам у защищённых особей
+void MeasureMemetic(const TestFunction &function, const Options &options, vector<Measurement> &measurements) {
+	const size_t elites[] = { 0, 2 };
+	const char *modeNames[] = { "_off", "_on" };
+	const size_t runs = 10;
+
+	for (int i = 0; i < 2; i++) {
+		size_t reached = 0;
+		double evaluations = 0;
+
+		for (size_t run = 0; run < runs; run++) {
+			Config config = GetBenchmarkConfig(100, options.dimensions, function.left, function.right);
+			config.selectionType = SelectionType::Tournament;
+			config.maxEpochs = 5000;
+			config.maxValuelessEpochs = 5000; // останавливает только достижение цели
+			config.seed = run;
+			config.memeticElites = elites[i];
+
+			auto algorithm = MakeGeneticAlgorithm<30>(config, function.f);
+			size_t runEvaluations = 0;
+			bool runReached = false;
+
+			algorithm.OnEvaluated([&](decltype(algorithm) &algorithm) {
+				runEvaluations += algorithm.GetPopulation().GetEvaluations();
+
+				if (algorithm.GetBestEntity().GetScore() <= function.target) {
+					runReached = true;
+					algorithm.Stop();
+				}
+			});
+
+			algorithm.OnEpochEnd([&](decltype(algorithm) &algorithm) {
+				runEvaluations += algorithm.GetPopulation().GetLocalEvaluations();
+			});
+
+			algorithm.Run();
+
+			if (runReached) {
+				reached++;
+				evaluations += runEvaluations;
+			}
+		}
+
+		measurements.push_back({ "memetic", function.name + modeNames[i], 100, "reached", (double) reached / runs });
+		measurements.push_back({ "memetic", function.name + modeNames[i], 100, "evaluations", reached > 0 ? evaluations / reached : -1.0 });
+	}
+}
+
+// быстрая сортировка по недоминированию со сравнением всех пар точек (O(M N^2)), с которой сравниваются NonDominatedSort
+size_t PairwiseNonDominatedSort(const double *costs, size_t n, size_t objectives, vector<size_t> &ranks) {
+	vector<vector<size_t>> dominated(n); // точки, над которыми доминирует точка
+	vector<size_t> counts(n, 0); // число точек, доминирующих над точкой
+	vector<size_t> front;
+
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = i + 1; j < n; j++) {
+			if (Dominates(costs + i * objectives, costs + j * objectives, objectives)) {
+				dominated[i].push_back(j);
+				counts[j]++;
+			}
+			else if (Dominates(costs + j * objectives, costs + i * objectives, objectives)) {
+				dominated[j].push_back(i);
+				counts[i]++;
+			}
+		}
+
+	ranks.assign(n, 0);
+
+	for (size_t i = 0; i < n; i++)
+		if (counts[i] == 0)
+			front.push_back(i);
+
+	size_t fronts = 0;
+
+	while (!front.empty()) {
+		vector<size_t> next;
+
+		for (size_t i = 0; i < front.size(); i++) {
+			ranks[front[i]] = fronts;
+
+			for (size_t j = 0; j < dominated[front[i]].size(); j++)
+				if (--counts[dominated[front[i]][j]] == 0)
+					next.push_back(dominated[front[i]][j]);
+		}
+
+		front.swap(next);
+		fronts++;
+	}
+
+	return fronts;
+}
+
+// измерение сортировки по недоминированию на случайных точках с двумя и тремя целями, попарная сортировка - только на малых размерах
+// сравнение оценочной функции из библиотеки с функцией из main.cpp: библиотека загружается с множителем 2
+// и должна на случайных точках возвращать удвоенные значения Sample
+void MeasurePlugin(size_t size, const Options &options, vector<Measurement> &measurements) {
+	FitnessPlugin plugin(options.plugin, "2", options.dimensions);
+
+	size_t repeats = GetRepeats(size);
+	vector<double> x(size * options.dimensions);
+	vector<double> expected(size);
+	vector<double> scores(size);
+	Random random(42);
+
+	for (size_t i = 0; i < x.size(); i++)
+		x[i] = -5 + 10 * random.GetReal();
+
+	auto start = chrono::steady_clock::now();
+
+	for (size_t j = 0; j < repeats; j++)
+		Batch<Sample>(x.data(), expected.data(), size, options.dimensions);
+
+	measurements.push_back({ "plugin", "sample_compiled", size, "ns_per_point", GetSeconds(start) * 1e9 / (repeats * size) });
+
+	start = chrono::steady_clock::now();
+
+	for (size_t j = 0; j < repeats; j++)
+		plugin.Evaluate(x.data(), scores.data(), size);
+
+	measurements.push_back({ "plugin", "sample_plugin", size, "ns_per_point", GetSeconds(start) * 1e9 / (repeats * size) });
+
+	// библиотека может быть собрана с другими флагами, поэтому значения сравниваются с относительной точностью
+	for (size_t i = 0; i < size; i++)
+		if (fabs(scores[i] - 2 * expected[i]) > 1e-12 * max(1.0, fabs(2 * expected[i])))
+			throw runtime_error("plugin '" + options.plugin + "' disagrees with compiled function");
+}
+
+void MeasureParetoSort(size_t size, vector<Measurement> &measurements) {
+	size_t repeats = max((size_t) 1, (size_t) 200000 / size);
+	Random random(42);
+
+	for (size_t objectives = 2; objectives <= 3; objectives++) {
+		vector<double> costs(size * objectives);
+		vector<size_t> ranks;
+		vector<size_t> pairwiseRanks;
+
+		for (size_t i = 0; i < costs.size(); i++)
+			costs[i] = random.GetReal();
+
+		string suffix = "_m" + to_string(objectives);
+		auto start = chrono::steady_clock::now();
+
+		for (size_t j = 0; j < repeats; j++)
+			NonDominatedSort(costs.data(), size, objectives, ranks);
+
+		measurements.push_back({ "pareto", "sort" + suffix, size, "ns_per_point", GetSeconds(start) * 1e9 / (repeats * size) });
+
+		if (size > 1000)
+			continue;
+
+		start = chrono::steady_clock::now();
+
+		for (size_t j = 0; j < repeats; j++)
+			PairwiseNonDominatedSort(costs.data(), size, objectives, pairwiseRanks);
+
+		measurements.push_back({ "pareto", "pairwise" + suffix, size, "ns_per_point", GetSeconds(start) * 1e9 / (repeats * size) });
+
+		if (ranks != pairwiseRanks)
+			throw runtime_error("non-dominated sorts disagree");
+	}
+}
+
+// сравнение числа оценок в секунду поколенческого и стационарного алгоритмов на функции с переменным временем вычисления
+void MeasureThroughput(const Options &options, vector<Measurement> &measurements) {
+	Config config = GetBenchmarkConfig(64, options.dimensions, -5.12, 5.12);
+	config.threads = options.threads;
+	config.parallelThreshold = 0;
+	config.maxEpochs = 20;
+	config.maxValuelessEpochs = config.maxEpochs;
+	config.qualityEpsilon = 1e-300; // останавливаемся только по числу эпох
+
+	// поколенческий алгоритм: каждая эпоха ждёт самую медленную оценку
+	Population<30> population(config);
+	size_t evaluations = 0;
+	auto start = chrono::steady_clock::now();
+
+	for (size_t epoch = 0; epoch < config.maxEpochs; epoch++) {
+		population.Eval(config, VariableLatency);
+		evaluations += population.GetEvaluations();
+		population.Selection(config);
+		population.Crossbreeding(config);
+		population.Mutation(config);
+	}
+
+	measurements.push_back({ "throughput", "generational", config.populationSize, "evaluations_per_second", evaluations / GetSeconds(start) });
+
+	const ReplacementType replacements[] = { ReplacementType::Worst, ReplacementType::Tournament };
+	const char *replacementNames[] = { "steady_state_worst", "steady_state_tournament" };
+
+	for (int i = 0; i < 2; i++) {
+		Config steadyConfig = config;
+		steadyConfig.replacementType = replacements[i];
+
+		SteadyStateAlgorithm<30, Function> algorithm(steadyConfig, VariableLatency);
+		algorithm.Run();
+		measurements.push_back({ "throughput", replacementNames[i], config.populationSize, "evaluations_per_second", algorithm.GetEvaluationsPerSecond() });
+	}
+}
+
+// получение ключа измерения для сравнения с базовыми результатами
+string GetKey(const Measurement &measurement) {
+	return measurement.benchmark + "," + measurement.name + "," + to_string(measurement.size) + "," + measurement.metric;
+}
+
+// чтение базовых результатов в формате CSV
+map<string, double> ReadBaseline(const string &path) {
+	ifstream f(path);
+
+	if (!f)
+		throw runtime_error("unable to open baseline file '" + path + "'");
+
+	map<string, double> baseline;
+	string line;
+	getline(f, line); // пропускаем заголовок
+
+	while (getline(f, line)) {
+		vector<string> fields;
+		stringstream ss(line);
+		string field;
+
+		while (getline(ss, field, ','))
+			fields.push_back(field);
+
+		if (fields.size() < 5)
+			continue;
+
+		baseline[fields[0] + "," + fields[1] + "," + fields[2] + "," + fields[3]] = stod(fields[4]);
+	}
+
+	return baseline;
+}
+
+// относительное ухудшение значения по сравнению с базовым (положительное - хуже)
+double GetRegression(const string &metric, double value, double base) {
+	if (metric == "generations_per_second" || metric == "evaluations_per_second" || metric == "reached")
+		return base / value - 1; // больше - лучше
+
+	return value / base - 1; // меньше - лучше
+}
+
+// вывод результатов и сравнение с базовыми, возвращает число ухудшений
+int PrintMeasurements(const vector<Measurement> &measurements, const Options &options) {
+	map<string, double> baseline;
+
+	if (options.baseline != "")
+		baseline = ReadBaseline(options.baseline);
+
+	int regressions = 0;
+	cout << "benchmark,name,size,metric,value" << (options.baseline != "" ? ",baseline,change,status" : "") << endl;
+
+	for (size_t i = 0; i < measurements.size(); i++) {
+		const Measurement &m = measurements[i];
+		cout << m.benchmark << "," << m.name << "," << m.size << "," << m.metric << "," << m.value;
+
+		if (options.baseline != "") {
+			map<string, double>::iterator it = baseline.find(GetKey(m));
+
+			if (it == baseline.end()) {
+				cout << ",,,new";
+			}
+			else if (m.value < 0 || it->second < 0) {
+				// цель не достигнута хотя бы в одном из запусков
+				bool regressed = m.value < 0 && it->second >= 0;
+				regressions += regressed;
+				cout << "," << it->second << ",," << (regressed ? "regression" : "ok");
+			}
+			else {
+				double change = GetRegression(m.metric, m.value, it->second);
+				bool regressed = change > options.threshold;
+				regressions += regressed;
+				cout << "," << it->second << "," << change << "," << (regressed ? "regression" : "ok");
+			}
+		}
+
+		cout << endl;
+	}
+
+	return regressions;
+}
+
+// разбор аргументов командной строки
+Options ParseOptions(int argc, char **argv) {
+	Options options;
+	options.maxSize = 1000000;
+	options.dimensions = 2;
+	options.baseline = "";
+	options.threshold = 0.1;
+	options.threads = max(1u, thread::hardware_concurrency());
+	options.plugin = "";
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+
+		if (i + 1 >= argc)
+			throw runtime_error("missing value for argument '" + arg + "'");
+
+		if (arg == "--max-size") {
+			options.maxSize = stoul(argv[++i]);
+		}
+		else if (arg == "--dimensions") {
+			options.dimensions = stoul(argv[++i]);
+		}
+		else if (arg == "--baseline") {
+			options.baseline = argv[++i];
+		}
+		else if (arg == "--threshold") {
+			options.threshold = stod(argv[++i]);
+		}
+		else if (arg == "--threads") {
+			options.threads = stoul(argv[++i]);
+		}
+		else if (arg == "--plugin") {
+			options.plugin = argv[++i];
+		}
+		else {
+			throw runtime_error("unknown argument '" + arg + "'");
+		}
+	}
+
+	return options;
+}
+
+int main(int argc, char **argv) {
+	Options options = ParseOptions(argc, argv);
+	vector<Measurement> measurements;
+
+	for (size_t size = 100; size <= options.maxSize; size *= 10) {
+		MeasureOperators(size, options, measurements);
+		MeasureGenerations(size, options, measurements);
+		MeasureExpression(size, options, measurements);
+
+		if (size <= 100000)
+			MeasureParetoSort(size, measurements);
+
+		if (options.plugin != "")
+			MeasurePlugin(size, options, measurements);
+	}
+
+	const TestFunction functions[] = {
+		{ "rastrigin", Batch<Rastrigin>, -5.12, 5.12, 1e-2 },
+		{ "ackley", Batch<Ackley>, -32.768, 32.768, 1e-2 },
+		{ "schwefel", Batch<Schwefel>, -500, 500, 1 },
+		{ "griewank", Batch<Griewank>, -600, 600, 1e-1 }
+	};
+
+	for (int i = 0; i < 4; i++) {
+		MeasureConvergence(functions[i], options, measurements);
+		MeasureMemetic(functions[i], options, measurements);
+	}
+
+	MeasureDiversity(options, measurements);
+	MeasureThroughput(options, measurements);
+
+	return PrintMeasurements(measurements, options) > 0 ? 1 : 0; // ненулевой код при ухудшениях
+}
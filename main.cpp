@@ -1,5 +1,9 @@
 #include <iostream>
 #include <cmath>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <fstream>
 
 #include "Config.hpp"
 #include "ConfigParser.hpp"
@@ -7,58 +11,440 @@
 #include "Population.hpp"
 #include "Crossbreeding.hpp"
 #include "Mutation.hpp"
+#include "Islands.hpp"
+#include "SharedIslands.hpp"
+#include "Telemetry.hpp"
+#include "Checkpoint.hpp"
+#include "GeneticAlgorithm.hpp"
+#include "Sweep.hpp"
+#include "SteadyState.hpp"
+#include "Nsga2.hpp"
+#include "FitnessPlugin.hpp"
+#include "Expression.hpp"
 
 using namespace std;
 
-// оптимизируемая функция
+unique_ptr<FitnessPlugin> plugin; // оценочная функция из разделяемой библиотеки (если задана в конфигурации)
+unique_ptr<Expression> expression; // оценочная функция, заданная выражением в конфигурации
+
+// функция одной переменной
 double f(double x) {
 	return x * sin(x + 5) * cos(x - 6) * sin(x + 7) * cos(x - 8) * sin(x / 3);
 }
 
-int main() {
-	ConfigParser parser;
-	Config config = parser.Parse("config.txt");
-	PrintConfig(config); // выводим конфигурацию
+// оптимизируемая функция: сумма f по всем координатам точки
+double F(const double *x, size_t dimensions) {
+	if (plugin) {
+		double score;
+		plugin->Evaluate(x, &score, 1);
+		return score;
+	}
+
+	if (expression) {
+		double score;
+		expression->Evaluate(x, &score, 1);
+		return score;
+	}
+
+	double sum = 0;
+
+	for (size_t i = 0; i < dimensions; i++)
+		sum += f(x[i]);
+
+	return sum;
+}
+
+// пакетная оценка оптимизируемой функции: n точек по dimensions координат подряд
+void BatchF(const double *x, double *scores, size_t n, size_t dimensions) {
+	if (plugin) {
+		plugin->Evaluate(x, scores, n); // библиотека получает весь пакет за один вызов
+		return;
+	}
+
+	if (expression) {
+		expression->Evaluate(x, scores, n); // каждая инструкция выражения выполняется сразу над всем пакетом
+		return;
+	}
 
-	int nochangingIterations;
-	double prevBest;
+	for (size_t i = 0; i < n; i++)
+		scores[i] = F(x + i * dimensions, dimensions);
+}
+
+// вывод точки пространства поиска
+void PrintPoint(const vector<double> &x) {
+	if (x.size() == 1) {
+		cout << x[0];
+		return;
+	}
+
+	cout << "(";
+
+	for (size_t i = 0; i < x.size(); i++)
+		cout << (i > 0 ? ", " : "") << x[i];
+
+	cout << ")";
+}
+
+// передача записи телеметрии эпохи вместе со временем всех её фаз
+template <unsigned Bits, typename Operators>
+void PushTelemetry(TelemetryWriter *telemetry, const Population<Bits, Operators> &population, TelemetryRecord *&record) {
+	if (!record)
+		return;
 
-	Population population(config.populationSize); // создаём популяцию
+	for (int i = 0; i < PHASES; i++)
+		record->times[i] = population.GetStatistics().times[i];
 
-	for (size_t epoch = 0; epoch < config.maxEpochs; epoch++) {
-		population.Eval(config, f); // оцениваем популяцию
-		Entity bestEntity = population.GetBestEntity(config); // получаем лучшую особь
+	telemetry->Publish(); // запись на диск выполняет отдельный поток
+	record = nullptr;
+}
+
+// поиск экстремума с геномом из Bits бит и операторами Operators
+template <unsigned Bits, typename Operators>
+void Optimize(const Config &config) {
+	GeneticAlgorithm<Bits, BatchFunction, Operators> algorithm(config, BatchF); // создаём алгоритм с новой популяцией
+	unique_ptr<TelemetryWriter> telemetry;
+	TelemetryRecord *record = nullptr; // запись буфера телеметрии текущей эпохи (nullptr - буфер заполнен и запись отброшена)
+
+	// продолжаем с сохранённой эпохи с тем же состоянием генератора
+	if (config.resume && HasCheckpoint(config.checkpointPath))
+		algorithm.LoadCheckpoint(Checkpoint(config.checkpointPath));
+
+	if (config.telemetryFormat != TelemetryFormat::None)
+		telemetry = unique_ptr<TelemetryWriter>(new TelemetryWriter(config.telemetryPath, config.telemetryFormat, config.telemetryBuffer, config.telemetryPopulation ? config.populationSize : 0, config.dimensions * Genome<Bits>::Words));
 
-		double x = bestEntity.Eval(config.leftBorder, config.rightBorder);
-		cout << "Epoch " << epoch << "\tbest: f(x) = " << f(x) << ", where x = " << x << endl;
+	// вывод оценённой популяции до построения следующего поколения
+	algorithm.OnEvaluated([&](GeneticAlgorithm<Bits, BatchFunction, Operators> &algorithm) {
+		const Population<Bits, Operators> &population = algorithm.GetPopulation();
+		const Entity<Bits> &bestEntity = algorithm.GetEpochBest();
+		size_t epoch = algorithm.GetEpoch();
+
+		// запись заполняется прямо в буфере телеметрии и передаётся потоку записи в конце эпохи
+		if (telemetry && (record = telemetry->Acquire())) {
+			population.GetTelemetry(config, epoch, config.telemetryPopulation, *record);
+			record->diversity = algorithm.GetDiversity().GetDiversity();
+		}
+
+		// строки не сбрасываются по одной: вывод буферизуется до завершения
+		cout << "Epoch " << epoch << "\tbest: f(x) = " << bestEntity.GetScore() << ", where x = ";
+		PrintPoint(bestEntity.Eval(config));
+		cout << '\n';
 
 		if (config.debug) {
+			cout << "evaluations: " << population.GetEvaluations() << ", cache hits: " << population.GetCacheHits() << ", cache misses: " << population.GetCacheMisses() << '\n';
 			cout << population; // выводим текущую популяцию
-			cout << endl;
+			cout << '\n';
+		}
+
+		if (algorithm.IsCollapsed())
+			cout << "Diversity has collapsed to " << algorithm.GetDiversity().GetDiversity() << " (" << algorithm.GetDiversity().GetFixedBits() << " fixed bits), " << (config.diversityPolicy == DiversityPolicy::Mutation ? "boosting mutation" : "reseeding population") << '\n';
+
+		if (algorithm.GetStopReason() == StopReason::Valueless) {
+			cout << "Score has not improved over " << algorithm.GetNochangingIterations() << " epoches" << '\n'; // сообщаем об этом
+			PushTelemetry(telemetry.get(), population, record);
+		}
+		else if (algorithm.GetNochangingIterations() > 0) {
+			cout << "Score has not improved, (iteration: " << algorithm.GetNochangingIterations() << ")" << '\n';
+		}
+	});
+
+	// показатели завершённой эпохи и снимок перед следующей
+	algorithm.OnEpochEnd([&](GeneticAlgorithm<Bits, BatchFunction, Operators> &algorithm) {
+#if defined(GENETIC_PROFILE)
+		cout << "profile: " << algorithm.GetPopulation().GetStatistics() << '\n'; // показатели фаз эпохи
+#endif
+		// вычисления локального поиска выполняются после оценки и добавляются к вычислениям эпохи
+		if (config.memeticElites > 0) {
+			cout << "Local search: " << algorithm.GetPopulation().GetLocalEvaluations() << " evaluations" << '\n';
+
+			if (record)
+				record->evaluations += algorithm.GetPopulation().GetLocalEvaluations();
+		}
+
+		PushTelemetry(telemetry.get(), algorithm.GetPopulation(), record);
+
+		if (config.checkpointPath != "" && algorithm.GetEpoch() % config.checkpointInterval == 0)
+			algorithm.SaveCheckpoint(config.checkpointPath);
+	});
+
+	algorithm.Run();
+
+	if (telemetry && telemetry->GetDropped() > 0)
+		cout << "telemetry records dropped: " << telemetry->GetDropped() << '\n';
+}
+
+// поиск экстремума стационарным алгоритмом с геномом из Bits бит
+template <unsigned Bits>
+void OptimizeSteadyState(const Config &config) {
+	SteadyStateAlgorithm<Bits, Function> algorithm(config, F);
+
+	// обработчик вызывается потоком, завершившим эпоху, под блокировкой популяции
+	algorithm.OnEpochEnd([&config](SteadyStateAlgorithm<Bits, Function> &algorithm) {
+		const Entity<Bits> &bestEntity = algorithm.GetBestEntity();
+
+		cout << "Epoch " << algorithm.GetEpoch() - 1 << "\tbest: f(x) = " << bestEntity.GetScore() << ", where x = ";
+		PrintPoint(bestEntity.Eval(config));
+		cout << '\n';
+
+		if (algorithm.GetStopReason() == StopReason::Valueless) {
+			cout << "Score has not improved over " << algorithm.GetNochangingIterations() << " epoches" << '\n';
+		}
+		else if (algorithm.GetNochangingIterations() > 0) {
+			cout << "Score has not improved, (iteration: " << algorithm.GetNochangingIterations() << ")" << '\n';
+		}
+	});
+
+	algorithm.Run();
+	cout << "evaluations: " << algorithm.GetEvaluations() << ", time: " << algorithm.GetSeconds() << " s, evaluations per second: " << algorithm.GetEvaluationsPerSecond() << '\n';
+}
+
+// поиск фронта Парето многокритериальным алгоритмом с геномом из Bits бит (цели задаются выражениями функции через ';')
+template <unsigned Bits>
+void OptimizeNsga2(const Config &config) {
+	auto objectives = [](const double *x, double *scores, size_t n, size_t) {
+		expression->Evaluate(x, scores, n); // все цели вычисляются одной программой
+	};
+
+	Nsga2Algorithm<Bits, decltype(objectives)> algorithm(config, objectives);
+
+	algorithm.OnEpochEnd([](Nsga2Algorithm<Bits, decltype(objectives)> &algorithm) {
+		cout << "Epoch " << algorithm.GetEpoch() - 1 << "\tfronts: " << algorithm.GetFronts() << ", pareto front: " << algorithm.GetFront().size() << " points" << '\n';
+	});
+
+	algorithm.Run();
+
+	vector<ParetoPoint> front = algorithm.GetFront();
+	cout << "Pareto front (" << front.size() << " points):" << endl;
+
+	for (size_t i = 0; i < front.size(); i++) {
+		cout << "f = ";
+		PrintPoint(front[i].scores);
+		cout << ", where x = ";
+		PrintPoint(front[i].x);
+		cout << endl;
+	}
+
+	if (config.paretoPath == "")
+		return;
+
+	ofstream output(config.paretoPath);
+
+	if (!output)
+		throw runtime_error("unable to open pareto file '" + config.paretoPath + "'");
+
+	for (size_t i = 0; i < config.dimensions; i++)
+		output << "x" << (i + 1) << ",";
+
+	for (size_t i = 0; i < config.objectives; i++)
+		output << "f" << (i + 1) << (i + 1 < config.objectives ? "," : "\n");
+
+	output.precision(17);
+
+	for (size_t i = 0; i < front.size(); i++) {
+		for (size_t j = 0; j < config.dimensions; j++)
+			output << front[i].x[j] << ",";
+
+		for (size_t j = 0; j < config.objectives; j++)
+			output << front[i].scores[j] << (j + 1 < config.objectives ? "," : "\n");
+	}
+}
+
+// поиск экстремума моделью островов с геномом из Bits бит
+template <unsigned Bits>
+void OptimizeIslands(const vector<Config> &configs) {
+	IslandModel<Bits> model(configs);
+	model.Start(BatchF); // острова работают в своих потоках
+
+	double best = model.GetGlobalBest();
+
+	// главный поток только наблюдает за общим лучшим значением и не задерживает острова
+	while (!model.IsFinished()) {
+		this_thread::sleep_for(chrono::milliseconds(10));
+
+		if (model.GetGlobalBest() != best) {
+			best = model.GetGlobalBest();
+			cout << "global best: f(x) = " << best << endl;
 		}
+	}
+
+	model.Wait();
+
+	const vector<IslandResult<Bits>> &results = model.GetResults();
+
+	for (size_t i = 0; i < results.size(); i++) {
+		cout << "Island " << i << "\tepochs: " << results[i].epochs << ", best: f(x) = " << results[i].best.GetScore() << ", where x = ";
+		PrintPoint(results[i].best.Eval(configs[i]));
+		cout << ", migrants sent: " << results[i].sent << ", received: " << results[i].received << ", dropped: " << results[i].dropped << endl;
+	}
+
+	size_t island = model.GetBestIsland();
+	cout << "Best: f(x) = " << results[island].best.GetScore() << ", where x = ";
+	PrintPoint(results[island].best.Eval(configs[island]));
+	cout << " (island " << island << ")" << endl;
+}
 
-		double currBest = bestEntity.GetScore(); // получаем оценку приспособленности
+// поиск экстремума островами в отдельных процессах с общим критерием остановки
+template <unsigned Bits>
+void OptimizeProcesses(const Config &config, const vector<Config> &configs) {
+	ProcessIslandModel<Bits> model(configs);
+	model.Start(BatchF); // острова работают в своих процессах
 
-		// если не нулевая эпоха и значение изменилось недостаточно сильно
-		if (epoch > 0 && (fabs(prevBest - currBest) < config.qualityEpsilon)) {
-			nochangingIterations++; // увеличиваем счётчик эпох без изменений
+	size_t nochangingIterations = 0;
+	size_t prevEpoch = 0;
+	double prevBest = 0;
+
+	// координатор следит за эпохой, пройденной всеми островами, и применяет к ней правило остановки
+	while (!model.IsFinished()) {
+		this_thread::sleep_for(chrono::milliseconds(10));
+
+		size_t epoch = model.GetEpoch();
+
+		if (epoch == prevEpoch)
+			continue;
+
+		double currBest = model.GetGlobalBest();
+		cout << "Epoch " << epoch - 1 << "\tglobal best: f(x) = " << currBest << endl;
+
+		// между проверками острова могли пройти несколько эпох
+		if (prevEpoch > 0 && fabs(prevBest - currBest) < config.qualityEpsilon) {
+			nochangingIterations += epoch - prevEpoch;
 
-			// если превышен лимит без изменений
 			if (nochangingIterations >= config.maxValuelessEpochs) {
-				cout << "Score has not improved over " << nochangingIterations << " epoches" << endl; // сообщаем об этом
-				break; // и выходим
+				cout << "Score has not improved over " << nochangingIterations << " epoches" << endl;
+				model.Stop(); // острова завершатся после текущей эпохи
+				break;
 			}
-
-			cout << "Score has not improved, (iteration: " << nochangingIterations << ")" << endl;
 		}
 		else {
 			nochangingIterations = 0;
 		}
 
-		prevBest = currBest; // обновляем предыдущее лучшее значение
+		prevEpoch = epoch;
+		prevBest = currBest;
+	}
+
+	model.Wait();
+
+	const vector<IslandResult<Bits>> &results = model.GetResults();
+
+	for (size_t i = 0; i < results.size(); i++) {
+		cout << "Island " << i << "\tepochs: " << results[i].epochs << ", best: f(x) = " << results[i].best.GetScore() << ", where x = ";
+		PrintPoint(results[i].best.Eval(configs[i]));
+		cout << ", migrants sent: " << results[i].sent << ", received: " << results[i].received << ", dropped: " << results[i].dropped << endl;
+	}
+
+	size_t island = model.GetBestIsland();
+	cout << "Best: f(x) = " << results[island].best.GetScore() << ", where x = ";
+	PrintPoint(results[island].best.Eval(configs[island]));
+	cout << " (island " << island << ")" << endl;
+}
+
+// поиск экстремума одной популяцией с подходящей под конфигурацию заранее инстанцированной комбинацией операторов
+template <unsigned Bits>
+struct OptimizeAction {
+	const Config &config;
+
+	template <typename Operators>
+	void Run() {
+		Optimize<Bits, Operators>(config);
+	}
+};
+
+// перебор сочетаний параметров с выводом сводной таблицы
+template <unsigned Bits>
+void Sweep(const Config &config, const vector<SweepPoint> &points) {
+	cout << "Sweep: " << points.size() << " configurations x " << config.sweepSeeds << " seeds on " << config.sweepThreads << " threads" << endl;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<SweepResult> results = RunSweep<Bits>(config, points, BatchF);
+	double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	PrintSweepResults(config, results);
+	cout << "total time: " << time << " s" << endl;
+}
+
+// запуск перебора параметров, одной популяции или модели островов
+template <unsigned Bits>
+void Run(const Config &config, const vector<Config> &islands, const vector<SweepPoint> &points) {
+	if (config.sweepMode != SweepMode::None) {
+		Sweep<Bits>(config, points);
+	}
+	else if (config.algorithmType == AlgorithmType::SteadyState) {
+		OptimizeSteadyState<Bits>(config);
+	}
+	else if (config.algorithmType == AlgorithmType::Nsga2) {
+		OptimizeNsga2<Bits>(config);
+	}
+	else if (islands.size() > 1 && config.islandMode == IslandMode::Processes) {
+		OptimizeProcesses<Bits>(config, islands);
+	}
+	else if (islands.size() > 1) {
+		OptimizeIslands<Bits>(islands);
+	}
+	else {
+		OptimizeAction<Bits> action = { config };
+		DispatchOperators(config, action, SpecializedOperators()); // без подходящей комбинации используется выбор операторов во время работы
+	}
+}
+
+int main() {
+	ConfigParser parser;
+	Config config = parser.Parse("config.txt");
+
+	// при продолжении работы используется конфигурация из снимка
+	if (config.resume && HasCheckpoint(config.checkpointPath)) {
+		Checkpoint checkpoint(config.checkpointPath);
+		config = checkpoint.GetConfig(config);
+		cout << "Resuming from checkpoint '" << config.checkpointPath << "' at epoch " << checkpoint.GetState().epoch << endl;
+	}
+
+	PrintConfig(config); // выводим конфигурацию
+
+	// библиотека загружается до запуска потоков и процессов островов и используется всеми ими
+	if (config.pluginPath != "")
+		plugin = unique_ptr<FitnessPlugin>(new FitnessPlugin(config.pluginPath, config.pluginArgs, config.dimensions));
+
+	if (config.function != "")
+		expression = unique_ptr<Expression>(new Expression(config.function, config.dimensions));
+
+	vector<Config> islands;
+
+	// у каждого острова свои параметры поверх общей конфигурации
+	for (size_t i = 0; i < config.islands; i++)
+		islands.push_back(parser.GetIslandConfig(config, i));
+
+	vector<SweepPoint> points;
+
+	// все сочетания проверяются до запуска, чтобы ошибка в значениях не прерывала перебор на середине
+	if (config.sweepMode != SweepMode::None)
+		points = GetSweepPoints(parser, config);
+
+	// размер генома известен на этапе компиляции, поэтому выбираем подходящую реализацию
+	switch (config.genomeBits) {
+		case 16:
+			Run<16>(config, islands, points);
+			break;
+
+		case 30:
+			Run<30>(config, islands, points);
+			break;
+
+		case 32:
+			Run<32>(config, islands, points);
+			break;
+
+		case 64:
+			Run<64>(config, islands, points);
+			break;
+
+		case 128:
+			Run<128>(config, islands, points);
+			break;
+
+		case 256:
+			Run<256>(config, islands, points);
+			break;
 
-		population.Selection(config); // запускаем селекцию
-		population.Crossbreeding(config); // запускаем скрещивание
-		population.Mutation(config); // запускаем мутацию
+		default:
+			throw std::runtime_error("unsupported genome bits");
 	}
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include <cmath>
+#include <cstdlib>
+
+#include "../GeneticPlugin.h"
+
+// пример подключаемой оценочной функции: та же функция, что и F в main.cpp, умноженная на множитель из plugin_args
+// сборка: g++ -Wall -O2 -march=native -shared -fPIC plugins/ExamplePlugin.cpp -o plugins/example.so
+
+// контекст: параметры, заданные при инициализации
+struct ExampleContext {
+	size_t dimensions; // число измерений
+	double factor; // множитель значения
+};
+
+// функция одной переменной
+static double f(double x) {
+	return x * sin(x + 5) * cos(x - 6) * sin(x + 7) * cos(x - 8) * sin(x / 3);
+}
+
+unsigned genetic_plugin_version(void) {
+	return GENETIC_PLUGIN_ABI_VERSION;
+}
+
+int genetic_plugin_init(size_t dimensions, const char *args, void **ctx) {
+	char *end = NULL;
+	double factor = args[0] ? strtod(args, &end) : 1; // пустая строка - без множителя
+
+	// множитель должен быть числом, иначе инициализация не удаётся и программа сообщает об ошибке
+	if (args[0] && *end != '\0')
+		return -1;
+
+	ExampleContext *context = new ExampleContext();
+	context->dimensions = dimensions;
+	context->factor = factor;
+
+	*ctx = context;
+	return 0;
+}
+
+void genetic_plugin_evaluate(const double *xs, double *out, size_t n, void *ctx) {
+	const ExampleContext *context = (const ExampleContext *) ctx;
+
+	for (size_t i = 0; i < n; i++) {
+		const double *x = xs + i * context->dimensions;
+		double sum = 0;
+
+		for (size_t j = 0; j < context->dimensions; j++)
+			sum += f(x[j]);
+
+		out[i] = sum * context->factor;
+	}
+}
+
+void genetic_plugin_release(void *ctx) {
+	delete (ExampleContext *) ctx;
+}
@@ -0,0 +1,177 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "../FitnessPlugin.hpp"
+#include "../Random.hpp"
+
+// проверка загрузки оценочных функций из разделяемых библиотек
+// собирает plugins/ExamplePlugin.cpp и сравнивает его значения с функцией F из main.cpp, а также собирает заведомо
+// неисправные библиотеки и проверяет, что FitnessPlugin отклоняет их с понятной ошибкой
+// сборка и запуск из корня репозитория: g++ -Wall -std=c++11 -O2 plugins/PluginTest.cpp -o plugin_test -ldl && ./plugin_test
+// компилятор библиотек задаётся переменной окружения CXX (по умолчанию g++)
+
+using namespace std;
+
+// функция одной переменной (как в main.cpp)
+double f(double x) {
+	return x * sin(x + 5) * cos(x - 6) * sin(x + 7) * cos(x - 8) * sin(x / 3);
+}
+
+// оптимизируемая функция из main.cpp: сумма f по всем координатам точки
+double F(const double *x, size_t dimensions) {
+	double sum = 0;
+
+	for (size_t i = 0; i < dimensions; i++)
+		sum += f(x[i]);
+
+	return sum;
+}
+
+// каталог для исходников и собранных библиотек
+struct TestDirectory {
+	string path;
+
+	TestDirectory() {
+		char name[] = "/tmp/genetic_plugin_XXXXXX";
+
+		if (!mkdtemp(name))
+			throw runtime_error("unable to create temporary directory");
+
+		path = name;
+	}
+
+	~TestDirectory() {
+		string command = "rm -rf '" + path + "'";
+
+		if (system(command.c_str()) != 0)
+			cerr << "unable to remove " << path << endl;
+	}
+};
+
+// сборка разделяемой библиотеки из исходника
+string BuildPlugin(const string &source, const string &directory, const string &name) {
+	const char *compiler = getenv("CXX");
+	string library = directory + "/" + name + ".so";
+	string command = string(compiler ? compiler : "g++") + " -Wall -O2 -shared -fPIC -I. '" + source + "' -o '" + library + "'";
+
+	if (system(command.c_str()) != 0)
+		throw runtime_error("unable to build plugin '" + source + "'");
+
+	return library;
+}
+
+// сборка библиотеки из текста исходника
+string BuildPluginSource(const string &code, const string &directory, const string &name) {
+	string source = directory + "/" + name + ".cpp";
+	ofstream output(source);
+	output << "#include \"GeneticPlugin.h\"\n\n" << code;
+	output.close();
+	return BuildPlugin(source, directory, name);
+}
+
+// сравнение значений библиотеки с factor * F на случайных точках
+void CheckValues(const string &library, const string &args, double factor, size_t dimensions) {
+	FitnessPlugin plugin(library, args, dimensions);
+	size_t size = 1000;
+	vector<double> x(size * dimensions);
+	vector<double> scores(size);
+	Random random(42);
+
+	for (size_t i = 0; i < x.size(); i++)
+		x[i] = -5 + 10 * random.GetReal();
+
+	plugin.Evaluate(x.data(), scores.data(), size);
+
+	// библиотека собирается с другими флагами, поэтому значения сравниваются с относительной точностью
+	for (size_t i = 0; i < size; i++) {
+		double expected = factor * F(x.data() + i * dimensions, dimensions);
+
+		if (fabs(scores[i] - expected) > 1e-12 * max(1.0, fabs(expected)))
+			throw runtime_error("plugin value " + to_string(scores[i]) + " differs from F value " + to_string(expected));
+	}
+}
+
+// проверка, что загрузка библиотеки завершается ошибкой с заданным фрагментом сообщения
+void CheckError(const string &library, const string &args, const string &message) {
+	try {
+		FitnessPlugin plugin(library, args, 2);
+	}
+	catch (const runtime_error &error) {
+		if (string(error.what()).find(message) == string::npos)
+			throw runtime_error("unexpected error: " + string(error.what()));
+
+		return;
+	}
+
+	throw runtime_error("plugin was loaded without error");
+}
+
+// исправная библиотека без необязательной функции освобождения контекста
+const char *withoutRelease =
+	"static double factor = 3;\n"
+	"unsigned genetic_plugin_version(void) { return GENETIC_PLUGIN_ABI_VERSION; }\n"
+	"int genetic_plugin_init(size_t, const char *, void **ctx) { *ctx = &factor; return 0; }\n"
+	"void genetic_plugin_evaluate(const double *xs, double *out, size_t n, void *ctx) { for (size_t i = 0; i < n; i++) out[i] = xs[i] * *(double *) ctx; }\n";
+
+// библиотека без обязательной пакетной оценки
+const char *withoutEvaluate =
+	"unsigned genetic_plugin_version(void) { return GENETIC_PLUGIN_ABI_VERSION; }\n"
+	"int genetic_plugin_init(size_t, const char *, void **ctx) { *ctx = 0; return 0; }\n";
+
+// библиотека, собранная с другой версией интерфейса
+const char *wrongVersion =
+	"unsigned genetic_plugin_version(void) { return GENETIC_PLUGIN_ABI_VERSION + 1; }\n"
+	"int genetic_plugin_init(size_t, const char *, void **ctx) { *ctx = 0; return 0; }\n"
+	"void genetic_plugin_evaluate(const double *, double *, size_t, void *) {}\n";
+
+int main() {
+	TestDirectory directory;
+	string example = BuildPlugin("plugins/ExamplePlugin.cpp", directory.path, "example");
+	string version = to_string(GENETIC_PLUGIN_ABI_VERSION);
+	int failed = 0;
+
+	// каждая проверка выполняется отдельно, чтобы сообщить обо всех ошибках сразу
+	auto check = [&failed](const string &name, const function<void()> &test) {
+		try {
+			test();
+			cout << "ok " << name << endl;
+		}
+		catch (const exception &error) {
+			cout << "FAILED " << name << ": " << error.what() << endl;
+			failed++;
+		}
+	};
+
+	check("example without factor", [&]() { CheckValues(example, "", 1, 1); });
+	check("example with factor", [&]() { CheckValues(example, "2", 2, 3); });
+	check("example with invalid factor", [&]() { CheckError(example, "abc", "failed to initialize with args 'abc'"); });
+
+	check("optional release", [&]() {
+		FitnessPlugin plugin(BuildPluginSource(withoutRelease, directory.path, "without_release"), "", 1);
+		double x = 2;
+		double score = 0;
+		plugin.Evaluate(&x, &score, 1);
+
+		if (score != 6)
+			throw runtime_error("unexpected value " + to_string(score));
+	});
+
+	check("missing symbol", [&]() { CheckError(BuildPluginSource(withoutEvaluate, directory.path, "without_evaluate"), "", "does not export genetic_plugin_evaluate"); });
+	check("abi version mismatch", [&]() { CheckError(BuildPluginSource(wrongVersion, directory.path, "wrong_version"), "", "expected " + version); });
+	check("missing library", [&]() { CheckError(directory.path + "/missing.so", "", "unable to load plugin"); });
+
+	if (failed > 0) {
+		cout << failed << " checks failed" << endl;
+		return 1;
+	}
+
+	cout << "all checks passed" << endl;
+	return 0;
+}